@@ -0,0 +1,51 @@
+/** Placement of the calling process on CPUs and NUMA memory nodes.
+
+    These use sched_setaffinity(2) and set_mempolicy(2) and so only
+    do something on Linux.  Both apply to the calling thread and are
+    inherited by threads and processes it later starts, so they are
+    best called before any work begins.
+ */
+
+#ifndef WIRECELL_PGRAPH_AFFINITY
+#define WIRECELL_PGRAPH_AFFINITY
+
+#include <string>
+#include <vector>
+
+namespace WireCell {
+    namespace Pgraph {
+
+        // Parse a CPU list such as "0-3,8,10-11".  Throws
+        // ValueError if malformed.
+        std::vector<int> parse_cpus(const std::string& spec);
+
+        // Run only on the given CPUs.  Return false if not possible.
+        bool pin_cpus(const std::vector<int>& cpus);
+
+        // Prefer to allocate memory on the given NUMA node.  Return
+        // false if not possible.
+        bool bind_numa(int node);
+
+        // Return the NUMA node holding the CPU or -1 if unknown.
+        int cpu_numa_node(int cpu);
+
+        // Remember the CPUs and memory policy of the calling thread
+        // on construction and restore them on destruction, for
+        // placing a thread only for a while.
+        class SavedPlacement {
+        public:
+            SavedPlacement();
+            ~SavedPlacement();
+
+            SavedPlacement(const SavedPlacement&) = delete;
+            SavedPlacement& operator=(const SavedPlacement&) = delete;
+
+        private:
+            std::vector<int> m_cpus; // empty if unknown
+            int m_mode;              // -1 if unknown
+            std::vector<unsigned long> m_nodes;
+        };
+
+    }
+}
+#endif
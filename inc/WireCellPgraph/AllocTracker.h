@@ -0,0 +1,42 @@
+/** Opt-in accounting of heap allocations made through global
+    operator new and delete, attributed to whatever the calling
+    thread has attached.
+
+    The replacement operators, including the aligned ones, are not
+    part of this library but of libWireCellPgraphAlloc, which must be
+    preloaded, eg with LD_PRELOAD, for the accounting to take effect.
+    Without it nothing is accounted and the standard operators are
+    left alone.  Use active() to check.  Accounting relies on
+    malloc_usable_size() and so is only available with glibc.
+ */
+
+#ifndef WIRECELL_PGRAPH_ALLOCTRACKER
+#define WIRECELL_PGRAPH_ALLOCTRACKER
+
+#include <cstddef>
+#include <cstdint>
+
+namespace WireCell {
+    namespace Pgraph {
+
+        struct AllocStats {
+            uint64_t nallocs{0}, nfrees{0};
+            uint64_t alloc_bytes{0}, free_bytes{0};
+            // Largest net number of bytes allocated and not yet
+            // freed within any one attachment.
+            int64_t peak_bytes{0};
+        };
+
+        namespace AllocTracker {
+
+            // Return true if allocations pass through the tracker.
+            bool active();
+
+            // Attribute allocations on the calling thread to stats
+            // until detach().
+            void attach(AllocStats* stats);
+            void detach();
+        }
+    }
+}
+#endif
@@ -0,0 +1,98 @@
+/** Contiguous storage for the parts of a graph.
+
+    An arena hands out memory from large chunks, one after the other,
+    and only gives it back all at once when it is destroyed.  Objects
+    made in it are destroyed in the reverse order they were made.
+    Nodes and edges made together thus sit together in memory and
+    building and tearing down a graph costs a few chunk allocations
+    instead of one per part.  Ports are not in the arena as nodes
+    make them in their constructors, before any arena is known.
+
+    An arena is not thread safe.  It is meant to be filled while a
+    graph is built and then left alone.
+ */
+
+#ifndef WIRECELL_PGRAPH_ARENA
+#define WIRECELL_PGRAPH_ARENA
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace WireCell {
+    namespace Pgraph {
+
+        class Arena {
+        public:
+            // Chunks are at least this many bytes.
+            explicit Arena(size_t chunk=65536);
+            ~Arena();
+
+            Arena(const Arena&) = delete;
+            Arena& operator=(const Arena&) = delete;
+
+            // Return memory for bytes with the given alignment.
+            void* allocate(size_t bytes, size_t align);
+
+            // Make an object in the arena.  It is destroyed with the
+            // arena.
+            template<class T, typename... Args>
+            T* make(Args&&... args) {
+                void* mem = allocate(sizeof(T), alignof(T));
+                T* obj = new (mem) T(std::forward<Args>(args)...);
+                m_made.push_back(Made{obj, &destroy<T>});
+                return obj;
+            }
+
+            size_t chunks() const { return m_chunks.size(); }
+            size_t bytes() const { return m_bytes; } // handed out
+
+        private:
+            template<class T>
+            static void destroy(void* obj) {
+                static_cast<T*>(obj)->~T();
+            }
+            struct Made {
+                void* obj;
+                void (*destroy)(void*);
+            };
+            std::vector<Made> m_made;
+
+            size_t m_chunk, m_bytes;
+            std::vector<std::unique_ptr<char[]> > m_chunks;
+            char* m_next;
+            size_t m_left;
+        };
+
+        // An allocator from a shared arena, as for std::allocate_shared.
+        // Each allocation keeps the arena alive, so objects made with
+        // it may outlive whoever made them.  Deallocation is a no-op.
+        template<typename T>
+        struct ArenaAllocator {
+            typedef T value_type;
+
+            explicit ArenaAllocator(std::shared_ptr<Arena> a) : arena(a) {}
+            template<typename U>
+            ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {}
+
+            T* allocate(size_t num) {
+                return static_cast<T*>(arena->allocate(num*sizeof(T), alignof(T)));
+            }
+            void deallocate(T*, size_t) { }
+
+            std::shared_ptr<Arena> arena;
+        };
+        template<typename T, typename U>
+        bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) {
+            return a.arena == b.arena;
+        }
+        template<typename T, typename U>
+        bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) {
+            return a.arena != b.arena;
+        }
+
+    }
+}
+#endif
@@ -0,0 +1,47 @@
+/** Derive engine settings from measured node costs.
+
+    A profile records the busy time of each named node of a graph as
+    {seconds, nodes:[{node, calls, fired, seconds}]} where each node
+    is given by the same "type:name" used in the Pgrapher edges.  It
+    may be saved by one job and used to tune a later one.
+
+    Tuning gives an overlay object which may be merged over the
+    Pgrapher configuration:
+
+      data: base + std.parseJson(importstr "overlay.json"),
+
+    It holds "threads" as the parallelism the measured costs allow,
+    "weight" as the total busy time for sharing an executor with
+    other graphs and, if asked for, "shards" as a split of the nodes
+    into that many parts of about equal busy time.  The push engine
+    calls one node at a time, so "threads" only matters where a pool
+    is used: with "prepare", "share_pool" or an "executor".
+ */
+
+#ifndef WIRECELL_PGRAPH_AUTOTUNE
+#define WIRECELL_PGRAPH_AUTOTUNE
+
+#include "WireCellPgraph/Graph.h"
+#include "WireCellUtil/Configuration.h"
+
+#include <string>
+#include <unordered_map>
+
+namespace WireCell {
+    namespace Pgraph {
+
+        // Return a profile of the named nodes from the graph's call
+        // statistics.
+        WireCell::Configuration make_profile(Graph& graph, const NodeNames& names);
+
+        // Return an overlay tuned to the profile.  If nshards is
+        // more than one, the nodes are split in topological order
+        // into that many shards of about equal busy time, only
+        // cutting where all edges cut have a serializer.
+        WireCell::Configuration autotune(Graph& graph, const NodeNames& names,
+                                         const WireCell::Configuration& profile,
+                                         size_t nshards=0);
+
+    }
+}
+#endif
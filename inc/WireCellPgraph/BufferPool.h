@@ -0,0 +1,99 @@
+/** A pool recycling large buffers between the nodes of a graph.
+
+    A node takes a buffer with acquire() and may pass it downstream,
+    for example held by the data it produces.  When the last
+    reference is dropped, wherever in the graph that happens, the
+    storage goes back to the pool instead of to the heap and a later
+    acquire() of the same type and similar size reuses it.  In steady
+    running this avoids repeatedly allocating and faulting in the same
+    large pages for every event.
+
+    Buffers are made with capacity rounded up to a power of two bytes
+    and kept by element type and capacity rounded down to one, so a
+    buffer a node grew is filed and counted by its new size.  A buffer is always handed out with its
+    elements value-initialized, as if newly made.  The pool may be
+    used from any thread and may be destroyed while buffers are still
+    out, which are then simply freed when released.
+ */
+
+#ifndef WIRECELL_PGRAPH_BUFFERPOOL
+#define WIRECELL_PGRAPH_BUFFERPOOL
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <typeindex>
+#include <vector>
+
+namespace WireCell {
+    namespace Pgraph {
+
+        class BufferPool {
+        public:
+            // Hold at most maxbytes of free buffers, zero for no
+            // limit.
+            explicit BufferPool(size_t maxbytes=0);
+
+            // Return a buffer of num elements.
+            template<typename T>
+            std::shared_ptr<std::vector<T> > acquire(size_t num) {
+                size_t bytes = capacity(num * sizeof(T));
+                auto vec = static_cast<std::vector<T>*>(
+                    m_state->take(Key(std::type_index(typeid(T)), bytes)));
+                if (!vec) {
+                    vec = new std::vector<T>;
+                    vec->reserve((bytes + sizeof(T) - 1) / sizeof(T));
+                }
+                vec->resize(num);
+                std::weak_ptr<State> weak = m_state;
+                return std::shared_ptr<std::vector<T> >(vec, [weak](std::vector<T>* v) {
+                        v->clear();
+                        size_t have = v->capacity() * sizeof(T);
+                        Key key(std::type_index(typeid(T)), filed(have));
+                        auto state = weak.lock();
+                        if (!state or !state->give(key, Free{v, &destroy<T>, have})) {
+                            delete v;
+                        }
+                    });
+            }
+
+            size_t hits() const;        // acquires reusing a buffer
+            size_t misses() const;      // acquires making a buffer
+            size_t held() const;        // bytes of free buffers
+
+        private:
+            typedef std::pair<std::type_index, size_t> Key;
+            struct Free {
+                void* ptr;
+                void (*destroy)(void*);
+                size_t bytes;   // of its capacity
+            };
+            // Shared with deleters of buffers which are out.
+            struct State {
+                size_t maxbytes{0}, held{0}, hits{0}, misses{0};
+                std::map<Key, std::vector<Free> > free;
+                mutable std::mutex mutex;
+
+                ~State();
+                void* take(const Key& key);
+                bool give(const Key& key, const Free& one);
+            };
+
+            template<typename T>
+            static void destroy(void* ptr) {
+                delete static_cast<std::vector<T>*>(ptr);
+            }
+
+            // Round up to a power of two bytes.
+            static size_t capacity(size_t bytes);
+
+            // Round down to a power of two bytes.
+            static size_t filed(size_t bytes);
+
+            std::shared_ptr<State> m_state;
+        };
+
+    }
+}
+#endif
@@ -0,0 +1,92 @@
+/** An opt-in cache of the results of deterministic Function nodes.
+
+    A cached function is looked up by a key made from a hash of a
+    string describing the node (typically its type, name and
+    configuration) and a hash of the serialized input.  Outputs are
+    kept in a directory on local disk so that later runs with
+    unchanged upstream configuration skip the work.
+
+    It is up to the user to only cache nodes which produce the same
+    output for the same input and configuration.  End-of-stream is
+    never cached and is always passed to the node.
+ */
+
+#ifndef WIRECELL_PGRAPH_CACHE
+#define WIRECELL_PGRAPH_CACHE
+
+#include "WireCellPgraph/Wrappers.h"
+#include "WireCellPgraph/Serializer.h"
+
+#include <list>
+#include <memory>
+#include <unordered_map>
+
+namespace WireCell {
+    namespace Pgraph {
+
+        // A directory of files by key with size-capped least
+        // recently used eviction.
+        class DiskCache {
+        public:
+            // A maxbytes of zero means no limit.
+            DiskCache(const std::string& dir, size_t maxbytes=0);
+
+            // Fill bytes and return true if key is held.
+            bool load(const std::string& key, std::string& bytes);
+
+            // Hold bytes under key, evicting as needed.
+            void store(const std::string& key, const std::string& bytes);
+
+            size_t hits() const { return m_hits; }
+            size_t misses() const { return m_misses; }
+            size_t evictions() const { return m_evictions; }
+            size_t bytes() const { return m_total; }
+
+        private:
+            std::string path(const std::string& key);
+            void evict();
+
+            std::string m_dir;
+            size_t m_max, m_total;
+            size_t m_hits, m_misses, m_evictions;
+
+            // Most recently used at front.
+            typedef std::list<std::pair<std::string, size_t> > lru_t;
+            lru_t m_lru;
+            std::unordered_map<std::string, lru_t::iterator> m_index;
+        };
+
+        // Return the SHA-256 hex digest of the bytes, used as a
+        // cache key.
+        std::string cache_hash(const std::string& bytes);
+
+        // A Function wrapper which consults a DiskCache.
+        class CachedFunction : public PortedNode {
+        public:
+            // The nodekey must change whenever the node would
+            // produce different output for the same input.
+            CachedFunction(INode::pointer wcnode,
+                           std::shared_ptr<DiskCache> cache,
+                           const std::string& nodekey);
+            virtual ~CachedFunction() {}
+
+            virtual bool operator()();
+            virtual size_t rate(Port::Type /*type*/, size_t /*ind*/=0) {
+                return 1;
+            }
+            virtual bool fire();
+
+            size_t hits() const { return m_hits; }
+            size_t misses() const { return m_misses; }
+
+        private:
+            IFunctionNodeBase::pointer m_wcnode;
+            std::shared_ptr<DiskCache> m_cache;
+            std::string m_nodehash;
+            Serializer *m_iser, *m_oser;
+            size_t m_hits, m_misses;
+        };
+
+    }
+}
+#endif
@@ -0,0 +1,31 @@
+/** Resources an engine shares with the nodes it runs.
+
+    A node may receive the context before execution, see
+    Node::set_context() and IContextual.  All members may be empty.
+ */
+
+#ifndef WIRECELL_PGRAPH_CONTEXT
+#define WIRECELL_PGRAPH_CONTEXT
+
+#include "WireCellPgraph/ThreadPool.h"
+#include "WireCellPgraph/BufferPool.h"
+
+#include <memory>
+
+namespace WireCell {
+    namespace Pgraph {
+
+        struct Context {
+            // Workers for parallel work within a node.  A node should
+            // use these rather than start its own threads so that
+            // work within and between nodes shares one set of cores.
+            std::shared_ptr<ThreadPool> pool;
+
+            // Recycled storage for large buffers passed between
+            // nodes.
+            std::shared_ptr<BufferPool> buffers;
+        };
+
+    }
+}
+#endif
@@ -0,0 +1,93 @@
+/** Run several graphs together on one pool of workers.
+
+    Graphs are added to a named executor and are all run by the
+    first call to run().  Each graph is stepped by at most one worker
+    at a time, a bounded number of node calls per step, so graphs
+    which do not depend on each other overlap and keep all workers
+    busy.  Workers go to the graph with the least work time divided
+    by its weight, so over a run each graph gets a share of the
+    workers in proportion to its weight.
+ */
+
+#ifndef WIRECELL_PGRAPH_EXECUTOR
+#define WIRECELL_PGRAPH_EXECUTOR
+
+#include "WireCellPgraph/Graph.h"
+#include "WireCellPgraph/ThreadPool.h"
+#include "WireCellUtil/Configuration.h"
+#include "WireCellUtil/Logging.h"
+
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace WireCell {
+    namespace Pgraph {
+
+        class Executor {
+        public:
+            Executor();
+
+            // Return the executor of the given name, made on first
+            // use.
+            static Executor& named(const std::string& name);
+
+            // Register a graph with a relative weight.  The setup
+            // function, if given, is called just before the graph is
+            // first stepped.  The graph is stepped quantum node calls
+            // at a time, zero meaning that set for the executor.
+            void add(Graph* graph, const std::string& name,
+                     double weight=1.0, std::function<void()> setup=nullptr,
+                     size_t quantum=0);
+
+            // True if the graph is registered and not yet run.
+            bool pending(Graph* graph);
+
+            // Ask for at least this many workers, zero meaning one
+            // per hardware thread.
+            void set_threads(size_t nthreads);
+
+            // The workers, made on first use.  These may also be
+            // shared with nodes, see Context.
+            std::shared_ptr<ThreadPool> pool();
+
+            // Number of node calls per step of a graph not added
+            // with its own, default 100.  It may be less than the
+            // number of nodes as each step resumes where the last
+            // left off.
+            void set_quantum(size_t ncalls) { m_quantum = ncalls; }
+
+            // Run all pending graphs until none can proceed and
+            // return per graph statistics as {graphs:[{name, weight,
+            // quantum, steps, calls, fired, seconds}], seconds}.
+            WireCell::Configuration run();
+
+        private:
+            struct Tenant {
+                Graph* graph;
+                std::string name;
+                double weight;
+                std::function<void()> setup;
+                size_t quantum{0};
+                double pass{0};     // work seconds over weight
+                bool pending{true}, running{false}, done{false};
+                size_t steps{0}, calls{0}, fired{0};
+                double seconds{0};
+            };
+
+            // Step graphs until all are done.
+            void work(std::vector<Tenant*>& active);
+
+            std::vector<std::unique_ptr<Tenant> > m_tenants;
+            size_t m_nthreads;
+            size_t m_quantum;
+            std::shared_ptr<ThreadPool> m_pool;
+            std::mutex m_mutex;
+            std::condition_variable m_cv;
+            Log::logptr_t l;
+        };
+
+    }
+}
+#endif
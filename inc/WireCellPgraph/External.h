@@ -0,0 +1,50 @@
+/** Nodes standing in for a host application at the boundary of a
+    graph.  Data the host pushes to an Ingress goes directly onto the
+    edge to the node it feeds and data reaching an Egress waits on its
+    edge until the host pulls it.  They are never ready to be called
+    themselves.  See Graph::add_ingress() and Graph::add_egress().
+ */
+
+#ifndef WIRECELL_PGRAPH_EXTERNAL
+#define WIRECELL_PGRAPH_EXTERNAL
+
+#include "WireCellPgraph/Node.h"
+
+namespace WireCell {
+    namespace Pgraph {
+
+        class Ingress : public Node {
+        public:
+            Ingress(const std::string& name, const std::string& signature);
+            virtual ~Ingress() {}
+
+            virtual bool operator()() { return false; }
+            virtual std::string ident();
+
+            void push(Data data);
+
+        private:
+            std::string m_name;
+        };
+
+        class Egress : public Node {
+        public:
+            Egress(const std::string& name, const std::string& signature);
+            virtual ~Egress() {}
+
+            virtual bool operator()() { return false; }
+            virtual std::string ident();
+
+            // Pop the next datum into data, return false if none.
+            bool pull(Data& data);
+
+            // Number of data waiting.
+            size_t size() { return iport().size(); }
+
+        private:
+            std::string m_name;
+        };
+
+    }
+}
+#endif
@@ -3,22 +3,26 @@
 
 
 #include "WireCellPgraph/Node.h"
+#include "WireCellPgraph/Arena.h"
 #include "WireCellUtil/Logging.h"
 #include "WireCellIface/INode.h"
 
 namespace WireCell {
     namespace Pgraph { 
 
-        // Makers make an appropriate Pgraph::Node from an INode
+        class Graph;
+
+        // Makers make an appropriate Pgraph::Node from an INode in
+        // the given arena.
         struct Maker {
             virtual ~Maker() {}
-            virtual Node* operator()(INode::pointer wcnode) = 0;
+            virtual Node* operator()(INode::pointer wcnode, Arena& arena) = 0;
         };
         template<class Wrapper>
         struct MakerT : public Maker {
             virtual ~MakerT() {}
-            virtual Node* operator()(INode::pointer wcnode) {
-                return new Wrapper(wcnode);
+            virtual Node* operator()(INode::pointer wcnode, Arena& arena) {
+                return arena.make<Wrapper>(wcnode);
             }
         };
 
@@ -28,20 +32,35 @@ namespace WireCell {
         class Factory {
         public:
 
+            // Nodes are owned by the factory and destroyed with it,
+            // so a graph of them must not outlive the factory.
             Factory();
 
+            // Nodes are owned by the graph and outlive the factory.
+            Factory(Graph& graph);
+
             typedef std::map<INode::pointer, Node*> WCNodeWrapperMap;
 
             template<class Wrapper>
             void bind_maker(INode::NodeCategory cat) {
-                m_factory[cat] = new MakerT<Wrapper>;
+                m_factory[cat].reset(new MakerT<Wrapper>);
             }
 
             Node* operator()(WireCell::INode::pointer wcnode);
 
+            // Use the given node, made elsewhere, for wcnode instead
+            // of making one.  The factory does not take ownership.
+            void bind_node(WireCell::INode::pointer wcnode, Node* node) {
+                m_nodes[wcnode] = node;
+            }
+
 
         private:
-            typedef std::map<INode::NodeCategory, Maker*> NodeMakers;
+            void bind_makers();
+
+            std::unique_ptr<Arena> m_own;
+            Arena& m_arena;
+            typedef std::map<INode::NodeCategory, std::unique_ptr<Maker> > NodeMakers;
             NodeMakers m_factory;
             WCNodeWrapperMap m_nodes;
             Log::logptr_t l;
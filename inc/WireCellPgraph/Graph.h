@@ -17,14 +17,31 @@
     
     A valid graph consists of nodes with all ports plugged to edges.
 
+    A graph owns the nodes it makes with make_node() and all of its
+    edges.  These are kept in arena storage so that they sit together
+    in memory and are freed together with the graph.  Nodes made
+    elsewhere and added or connected are not owned and must outlive
+    their use by the graph.  An edge lives on while any port holds it.
+
  */
 
 #ifndef WIRECELL_PGRAPH_GRAPH
 #define WIRECELL_PGRAPH_GRAPH
 
 #include "WireCellPgraph/Node.h"
+#include "WireCellPgraph/Arena.h"
+#include "WireCellPgraph/External.h"
+#include "WireCellPgraph/Latency.h"
+#include "WireCellPgraph/AllocTracker.h"
+#include "WireCellPgraph/ThreadPool.h"
+#include "WireCellPgraph/Metrics.h"
 #include "WireCellUtil/Logging.h"
+#include "WireCellUtil/Configuration.h"
 
+#include <atomic>
+#include <ostream>
+#include <memory>
+#include <chrono>
 #include <vector>
 #include <unordered_set>
 #include <unordered_map>
@@ -32,42 +49,345 @@
 namespace WireCell {
     namespace Pgraph {
 
+        // Names of nodes as given in configuration.
+        typedef std::unordered_map<Node*, std::string> NodeNames;
+
+        // A static schedule for a connected subgraph of nodes which
+        // all have fixed rates.  One period fires each node as many
+        // times as needed to return the internal edges to empty.
+        struct StaticSchedule {
+            // The member nodes.
+            std::vector<Node*> nodes;
+            // One period of node firings, in order.
+            std::vector<Node*> firings;
+            // Ports on edges entering the subgraph and the number of
+            // data objects they must hold to run one period.
+            std::vector<std::pair<Port*, size_t> > inputs;
+            // Largest depth each internal edge reaches in a period.
+            std::vector<size_t> bounds;
+        };
+
+        // Accumulated measures of calls to one node.
+        struct NodeStats {
+            size_t calls{0};    // all calls
+            size_t fired{0};    // calls which returned true
+            double seconds{0};  // wall clock time in all calls
+            // Sums of performance counters over all calls, in order
+            // of Graph::counter_names(), if enabled.
+            std::vector<uint64_t> counters;
+            // Heap use within calls, if enabled.
+            AllocStats alloc;
+        };
+
         class Graph {
         public:
             Graph();
 
+            Graph(const Graph&) = delete;
+            Graph& operator=(const Graph&) = delete;
+
             // Add a node to the graph.
             void add_node(Node* node);
 
+            // Make a node owned by the graph and add it.
+            template<class NodeType, typename... Args>
+            NodeType* make_node(Args&&... args) {
+                auto node = m_arena.make<NodeType>(std::forward<Args>(args)...);
+                add_node(node);
+                return node;
+            }
+
+            // The storage of owned nodes, for example for a Factory
+            // to make nodes in which are later added.
+            Arena& arena() { return m_arena; }
+
             // Connect two nodes by their given ports.  Return false
             // if they are incompatible.  new nodes will be implicitly
             // added to the graph.
             bool connect(Node* tail, Node* head,
                          size_t tpind=0, size_t hpind=0);
             
+            // Add a named open port through which a host may push()
+            // data to the given input port of the head node.
+            void add_ingress(const std::string& name, Node* head, size_t hpind=0);
+
+            // Add a named open port from which a host may pull() data
+            // produced on the given output port of the tail node.
+            void add_egress(const std::string& name, Node* tail, size_t tpind=0);
+
+            // Push data into the named ingress.  The datum is moved
+            // onto the edge, so passing an rvalue copies nothing.
+            void push(const std::string& name, Data data);
+
+            // Pull the next datum from the named egress into data.
+            // Return false if none is waiting.
+            bool pull(const std::string& name, Data& data);
+
+            // Return the number of data waiting at the named egress.
+            size_t waiting(const std::string& name);
+
+            // Keep only the targets and the nodes upstream of them.
+            // Outputs of kept nodes to other nodes are discarded.
+            // Call after connecting and before executing.  Return the
+            // number of nodes removed.  Throws ValueError if a target
+            // is not in the graph.
+            size_t prune(const std::vector<Node*>& targets);
+
             // return a topological sort of the graph as per Kahn algorithm.
             std::vector<Node*> sort_kahn();
 
+            // Call prepare() on all nodes concurrently using the pool.
+            void prepare(ThreadPool& pool);
+
+            // Give the context to all nodes.
+            void set_context(const Context& ctx);
+
             // Excute the graph until nodes stop delivering
             bool execute();
 
-            // Excute parents of node or if any parent is not ready,
-            // recursively call this method on parent.  Return number
-            // of nodes executed.
+            // Progress made by one step().
+            struct StepStats {
+                size_t calls{0};    // nodes called
+                size_t fired{0};    // calls which returned true
+                bool done{false};   // no node can proceed
+                double seconds{0};  // wall clock time taken
+            };
+
+            // Execute as execute() but return after max_calls node
+            // calls (zero means no limit) or once the deadline has
+            // passed, which is checked between calls.  Calling
+            // again continues where the last call left off, even in
+            // the middle of a sweep over the nodes, which allows a
+            // host to interleave graph execution with its own work.
+            // Done is only reported once every node has been called
+            // without any firing.  No watchdog is run.
+            StepStats step(size_t max_calls=0,
+                           std::chrono::steady_clock::time_point deadline
+                           = std::chrono::steady_clock::time_point::max());
+
+            // Excute the graph like execute() but run subgraphs of
+            // fixed-rate nodes from their static schedule.
+            bool execute_sdf();
+
+            // Find subgraphs of two or more connected nodes with
+            // fixed rates and compute their static schedules.
+            std::vector<StaticSchedule> static_schedules();
+
+            // Excute the graph by pulling on its sinks until no sink
+            // demand can be satisfied.  Nodes are only called when
+            // some downstream node needs their output.
+            bool execute_pull();
+
+            // Try to call node.  If it is not ready, propagate the
+            // demand upstream, calling parents as needed, and retry.
+            // Each node is asked at most once per call so the work
+            // is bounded and no recursion is used.  Return number of
+            // nodes executed.
             int execute_upstream(Node* node);
 
+            // Return the nodes which have no downstream nodes.
+            std::vector<Node*> sinks();
+
             // All internal calling of nodes goes through here.
             bool call_node(Node* node);
 
             // Return false if any node is not connected.
             bool connected();
 
+            // Inspect the graph for data left on edges and nodes
+            // unable to proceed.  The result has these attributes:
+            //
+            // - stalled :: true if any edge holds data.
+            // - edges :: non-empty edges as {tail, tport, head,
+            //   hport, depth}.
+            // - waiting :: nodes holding input or output as {node,
+            //   empty, blocked} listing input ports which are empty
+            //   and output ports which still hold data.
+            // - cycles :: lists of nodes which wait on each other.
+            //
+            // It may be called after execution or between node calls.
+            WireCell::Configuration diagnose();
+
+            // If positive, a watchdog thread warns when execution
+            // makes no progress for this many seconds.
+            void set_watchdog(double seconds) { m_watchdog = seconds; }
+
+            // Carry along each edge the time its data left a source
+            // and histogram the latency at which it reaches each
+            // sink.  Call after connecting and before executing.
+            void enable_latency();
+
+            // Read performance counters around each node call.  See
+            // PerfCounters.
+            void enable_counters() { m_counting = true; m_measuring = true; }
+            const std::vector<std::string>& counter_names();
+
+            // Attribute heap allocations to the node being called.
+            // Return false, and do nothing, if the AllocTracker is
+            // not active.
+            bool enable_alloc_tracking();
+
+            // Time each node call and keep call measures by node.
+            // Without this, or counters, allocation tracking or
+            // metrics which turn it on, calls are not measured.
+            void enable_stats() { m_measuring = true; }
+            bool stats_enabled() const { return m_measuring; }
+
+            // Call measures by node.
+            const std::unordered_map<Node*, NodeStats>& node_stats() const {
+                return m_stats;
+            }
+
+            // Return the node call measures and any latencies as
+            // {nodes:[{node, calls, fired, seconds, counters:{...},
+            // alloc:{...}}], latency:[{node, count, p50, p99, max}]}.
+            WireCell::Configuration statistics();
+
+            // Write a snapshot of node rates, busy fractions and edge
+            // depths to the file every interval seconds while
+            // executing and once at the end.  Snapshots are timed
+            // and written on their own thread.  Nodes are labeled by
+            // their names, else ident(), with "#n" added to any
+            // label already taken.  See MetricsWriter.
+            void set_metrics(const std::string& filename, double interval,
+                             const std::string& format="json");
+
+            // Write a snapshot soon if metrics are being written.
+            void publish_metrics();
+
+            // Name nodes as configured so reports can tell apart
+            // nodes of the same ident().
+            void set_names(const NodeNames& names) { m_names = names; }
+            const NodeNames& names() const { return m_names; }
+
+            // Write the graph in GraphViz DOT format with nodes
+            // labeled by ident() and edges by signature.  Once nodes
+            // have been called they are annotated with their calls,
+            // busy time and output count, edges with their peak
+            // depth, and the path from a source to a sink with the
+            // most busy time is drawn in red.
+            void write_dot(std::ostream& os);
+
+            // Return a hash of the graph structure, its edges by the
+            // ident(), any name and port of their ends, which a
+            // checkpoint must match to be loaded.
+            std::string fingerprint();
+
+            // Write the data on all edges, each with the serializer
+            // for its signature, and the state of all nodes.  Return
+            // false, having written nothing, if an edge holding data
+            // has no serializer or a node can not now save its state.
+            // Call only between node calls.
+            bool save_checkpoint(std::ostream& so);
+
+            // Restore from a checkpoint of a graph with the same
+            // fingerprint, after configuration and before execution.
+            // Throws IOError if it can not be read and ValueError if
+            // it is of another graph.
+            void load_checkpoint(std::istream& si);
+
+            // Have step() write a checkpoint to the file at the first
+            // safe point after every interval seconds.  The file is
+            // replaced whole so it always holds the last complete
+            // checkpoint.  When it is not safe the next try is
+            // after a sixteenth of the interval, doubling up to the
+            // interval while it stays unsafe.
+            void set_checkpoint(const std::string& filename, double interval);
+
+            // Write a checkpoint to the file now if safe.  Return
+            // false if not.
+            bool checkpoint();
+
+            // Number of checkpoints written.
+            size_t checkpoints() const { return m_checkpoints; }
+
+            // Latency from a source of the latest datum to reach a
+            // sink, zero until one has if latency is timed.
+            double recent_latency() const { return m_recent_latency; }
+
+            // Return the most data waiting on any one edge.
+            size_t max_depth();
+
+            // Latency histograms by sink node.
+            const std::unordered_map<Node*, LatencyHistogram>& latencies() const {
+                return m_latency;
+            }
+
+            // An edge as seen by the graph, its end nodes and ports.
+            struct EdgeEnds {
+                Node* tail;
+                Node* head;
+                size_t tpind, hpind;
+            };
+
+            // All edges in the order they were connected.
+            const std::vector<EdgeEnds>& edges() const { return m_edges; }
+
         private:
-            std::vector<std::pair<Node*,Node*> > m_edges;
+            // Owned nodes, destroyed last.
+            Arena m_arena;
+            // Edge queues, shared with ports.
+            std::shared_ptr<Arena> m_edge_arena;
+
+            std::vector<EdgeEnds> m_edges;
             std::unordered_set<Node*> m_nodes;
             std::unordered_map< Node*, std::vector<Node*> > m_edges_forward,
                 m_edges_backward;
             Log::logptr_t l;
+
+            Ingress* ingress(const std::string& name);
+            Egress* egress(const std::string& name);
+            std::unordered_map<std::string, Ingress*> m_ingress;
+            std::unordered_map<std::string, Egress*> m_egress;
+
+            // Cached topological sort.
+            const std::vector<Node*>& sorted();
+            std::vector<Node*> m_sorted;
+            size_t m_sorted_nedges;
+
+            // Where step() resumes its sweep and how many calls in a
+            // row have not fired.
+            size_t m_step_cursor, m_step_unfired;
+
+            // Surround every call to a node.
+            void begin_call(Node* node);
+            void end_call(Node* node, bool ok);
+
+            std::unordered_map<Node*, NodeStats> m_stats;
+            Stamp m_call_start;
+            bool m_measuring, m_counting, m_tracking_allocs;
+            std::vector<uint64_t> m_call_counters, m_counter_now;
+
+            bool m_timing_latency;
+            double m_recent_latency;
+            std::unordered_map<Node*, LatencyHistogram> m_latency;
+
+            // Publish a node's measures and its edge depths to the
+            // metrics writer, starting it on the first call.
+            void update_gauges(Node* node, const NodeStats& st);
+
+            NodeNames m_names;
+            std::unique_ptr<MetricsWriter> m_metrics;
+            std::shared_ptr<MetricsGauges> m_gauges;
+            struct NodeGauges {
+                MetricsGauges::Node* node{nullptr};
+                std::vector<std::pair<Port*, MetricsGauges::Edge*> > edges;
+            };
+            std::unordered_map<Node*, NodeGauges> m_node_gauges;
+
+            std::string m_checkpoint_file;
+            double m_checkpoint_interval;
+            // Wait before trying again after a checkpoint was not safe.
+            double m_checkpoint_backoff;
+            Stamp m_checkpoint_last;
+            size_t m_checkpoints;
+
+            double m_watchdog;
+            // Count successful calls and remember the current node
+            // for the watchdog.
+            std::atomic<size_t> m_progress;
+            std::atomic<Node*> m_current;
+            friend class Watchdog;
         };
 }
 }
@@ -0,0 +1,33 @@
+/** An optional interface for an INode which holds state that must be
+    kept to resume a graph from a checkpoint, such as the cursor of a
+    source into its input files.  Nodes which only transform what
+    they are given need not implement it.
+ */
+
+#ifndef WIRECELL_PGRAPH_ICHECKPOINTABLE
+#define WIRECELL_PGRAPH_ICHECKPOINTABLE
+
+#include "WireCellUtil/IComponent.h"
+
+#include <string>
+
+namespace WireCell {
+    namespace Pgraph {
+
+        class ICheckpointable : virtual public IComponent<ICheckpointable> {
+        public:
+            virtual ~ICheckpointable() {}
+
+            // Return an opaque blob from which load_state() may
+            // restore the node.  This is called between node calls.
+            virtual std::string save_state() = 0;
+
+            // Restore from a blob made by save_state(), possibly in
+            // an earlier process.  This is called after configuration
+            // and before execution.
+            virtual void load_state(const std::string& state) = 0;
+        };
+
+    }
+}
+#endif
@@ -0,0 +1,30 @@
+/** An optional interface for an INode which does parallel work of its
+    own, such as FFTs over many channels, or which makes or drops
+    large buffers.  Pgrapher may give it the engine's Context so that
+    this work runs on the shared pool of workers instead of
+    oversubscribing the cores with its own threads and so that
+    buffers are recycled instead of allocated anew for every event.
+ */
+
+#ifndef WIRECELL_PGRAPH_ICONTEXTUAL
+#define WIRECELL_PGRAPH_ICONTEXTUAL
+
+#include "WireCellPgraph/Context.h"
+#include "WireCellUtil/IComponent.h"
+
+namespace WireCell {
+    namespace Pgraph {
+
+        class IContextual : virtual public IComponent<IContextual> {
+        public:
+            virtual ~IContextual() {}
+
+            // Receive the context.  This is called before execution
+            // and the context stays valid at least until the graph
+            // is done.
+            virtual void set_context(const Context& ctx) = 0;
+        };
+
+    }
+}
+#endif
@@ -0,0 +1,28 @@
+/** An optional interface for an INode with expensive one-time setup
+    such as loading responses or building FFT plans.  Before a graph
+    executes, Pgrapher may call prepare() on all such nodes at once
+    from a pool of threads so the setup is not done one after another
+    on the first data.
+ */
+
+#ifndef WIRECELL_PGRAPH_IPREPARABLE
+#define WIRECELL_PGRAPH_IPREPARABLE
+
+#include "WireCellUtil/IComponent.h"
+
+namespace WireCell {
+    namespace Pgraph {
+
+        class IPreparable : virtual public IComponent<IPreparable> {
+        public:
+            virtual ~IPreparable() {}
+
+            // Do one-time setup.  This may run concurrently with the
+            // prepare() of other components but not with any other
+            // method of this one.
+            virtual void prepare() = 0;
+        };
+
+    }
+}
+#endif
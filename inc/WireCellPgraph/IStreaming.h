@@ -0,0 +1,39 @@
+/** An optional interface for an IQueuedoutNode which expands one
+    input into many outputs, such as a frame slicer.  Instead of
+    making all outputs in one call, the node is asked for them a
+    chunk at a time as downstream takes them.  Only about one chunk
+    is then held at once and downstream work overlaps with making
+    the rest.
+ */
+
+#ifndef WIRECELL_PGRAPH_ISTREAMING
+#define WIRECELL_PGRAPH_ISTREAMING
+
+#include "WireCellIface/IQueuedoutNode.h"
+#include "WireCellUtil/IComponent.h"
+
+namespace WireCell {
+    namespace Pgraph {
+
+        class IStreaming : virtual public IComponent<IStreaming> {
+        public:
+            virtual ~IStreaming() {}
+
+            // Start on a new input.  Return false if it can not be
+            // taken now, in which case it is offered again later.
+            virtual bool begin(const boost::any& in) = 0;
+
+            // Append up to max outputs for the current input.  Return
+            // false once the input is done, which may be with the
+            // last outputs appended.
+            virtual bool next(IQueuedoutNodeBase::queuedany& outq, size_t max) = 0;
+
+            // The number of outputs to ask for at once.  No more are
+            // asked for until downstream has taken fewer than this
+            // many from the output edge.
+            virtual size_t chunk() const { return 1; }
+        };
+
+    }
+}
+#endif
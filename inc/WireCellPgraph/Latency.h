@@ -0,0 +1,34 @@
+#ifndef WIRECELL_PGRAPH_LATENCY
+#define WIRECELL_PGRAPH_LATENCY
+
+#include <vector>
+#include <cstddef>
+
+namespace WireCell {
+    namespace Pgraph {
+
+        // A histogram of latencies in seconds with logarithmic bins
+        // spanning one microsecond to about three hours.  Quantiles
+        // are estimated to within one bin, about 12%.
+        class LatencyHistogram {
+        public:
+            LatencyHistogram();
+
+            void fill(double seconds);
+
+            size_t count() const { return m_count; }
+            double max() const { return m_max; }
+            double mean() const;
+
+            // Return the upper edge of the bin holding the given
+            // fraction (eg, 0.5, 0.99) of the entries.
+            double quantile(double frac) const;
+
+        private:
+            std::vector<size_t> m_bins;
+            size_t m_count;
+            double m_sum, m_max;
+        };
+    }
+}
+#endif
@@ -0,0 +1,99 @@
+/** Write snapshots of a running graph to a file for live monitoring.
+
+    The engine stores node counts and edge depths in atomic gauges as
+    it runs.  A background thread times the interval, reads the gauges
+    and writes a snapshot, so snapshots keep coming while a node call
+    runs long or the engine waits, the graph itself is never read
+    from two threads and writing never slows execution.  Each file is
+    written to a temporary name and renamed so a reader never sees a
+    partial snapshot.
+
+    The format is "json" or "prometheus" text exposition.
+ */
+
+#ifndef WIRECELL_PGRAPH_METRICS
+#define WIRECELL_PGRAPH_METRICS
+
+#include "WireCellUtil/Configuration.h"
+#include "WireCellUtil/Logging.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace WireCell {
+    namespace Pgraph {
+
+        // What the engine publishes.  Names are set before the
+        // writer starts and the values are updated while it runs.
+        struct MetricsGauges {
+            struct Node {
+                std::string name;
+                std::atomic<uint64_t> calls{0}, fired{0};
+                std::atomic<double> seconds{0};
+            };
+            struct Edge {
+                std::string tail, head;
+                int tport{0}, hport{0};
+                std::atomic<uint64_t> depth{0};
+            };
+            // Deques as atomics do not move.
+            std::deque<Node> nodes;
+            std::deque<Edge> edges;
+        };
+
+        class MetricsWriter {
+        public:
+            MetricsWriter(const std::string& filename, double interval,
+                          const std::string& format="json");
+            // Writes a last snapshot if started.
+            ~MetricsWriter();
+
+            // Start writing snapshots of the gauges every interval.
+            void start(std::shared_ptr<const MetricsGauges> gauges);
+            bool started() const { return (bool)m_gauges; }
+
+            // Write a snapshot soon, without waiting for the interval.
+            void flush();
+
+            double interval() const { return m_interval; }
+
+            // Return snapshot in Prometheus text format.
+            static std::string prometheus(const WireCell::Configuration& snapshot);
+
+        private:
+            void run();
+            // Return a snapshot of the gauges as {elapsed,
+            // nodes:[{node, calls, fired, seconds, rate, busy}],
+            // edges:[{tail, tport, head, hport, depth}]}.  Rates and
+            // busy fractions are over the time since the last.
+            WireCell::Configuration snapshot();
+            void write(const WireCell::Configuration& snapshot);
+
+            std::string m_filename, m_format;
+            double m_interval;
+
+            std::shared_ptr<const MetricsGauges> m_gauges;
+            std::chrono::steady_clock::time_point m_start, m_last;
+            struct Previous {
+                uint64_t fired{0};
+                double seconds{0};
+            };
+            std::vector<Previous> m_prev;
+
+            std::mutex m_mutex;
+            std::condition_variable m_cv;
+            bool m_flush, m_done;
+            std::thread m_thread;
+            Log::logptr_t l;
+        };
+
+    }
+}
+#endif
@@ -2,6 +2,7 @@
 #define WIRECELL_PGRAPH_NODE
 
 #include "WireCellPgraph/Port.h"
+#include "WireCellPgraph/Context.h"
 
 namespace WireCell {
     namespace Pgraph {
@@ -9,7 +10,7 @@ namespace WireCell {
         // A node in the DFP graph must inherit from Node.
         class Node {
         public:
-            Node() {} // constructures may wish to resize/populate m_ports.
+            Node() : m_has_origin(false), m_has_sent(false), m_sent_now(false) {} // constructures may wish to resize/populate m_ports.
             virtual ~Node() { }
             
             // Concrete Node must implement this to consume inputs
@@ -19,6 +20,42 @@ namespace WireCell {
             // Concrete node must return some instance identifier.
             virtual std::string ident() = 0;
 
+            // Return the number of data objects consumed (input) or
+            // produced (output) through the port on each successful
+            // call or 0 if that is not fixed at configure time.
+            // Nodes with fixed rates on all ports may be run from a
+            // static schedule.
+            virtual size_t rate(Port::Type /*type*/, size_t /*ind*/=0) {
+                return 0;
+            }
+
+            // Do any one-time setup before execution.  This may be
+            // called concurrently with that of other nodes.
+            virtual void prepare() { }
+
+            // Receive resources shared by the engine.
+            virtual void set_context(const Context& /*ctx*/) { }
+
+            // Fill state with what is needed to resume this node from
+            // a checkpoint.  Return false if the node is midway
+            // through work it can not save, in which case the
+            // checkpoint is tried again later.  Nodes without state
+            // need not override.
+            virtual bool save_state(std::string& /*state*/) {
+                return true;
+            }
+
+            // Restore from state filled by save_state().
+            virtual void load_state(const std::string& /*state*/) { }
+
+            // Consume and produce without checking if the node is
+            // ready.  This is only called from a static schedule
+            // which assures inputs are available.  Concrete nodes
+            // with fixed rates should override.
+            virtual bool fire() {
+                return (*this)();
+            }
+
             Port& iport(size_t ind=0) {
                 return port(Port::input, ind);
             }
@@ -63,9 +100,57 @@ namespace WireCell {
                 return true;
             }
 
+            // Note the stamp of a consumed datum.
+            void consumed(Stamp stamp) {
+                if (!m_has_origin or stamp < m_origin) {
+                    m_origin = stamp;
+                    m_has_origin = true;
+                }
+            }
+            // Note a result carrying the stamp has left the node.
+            void sent(Stamp stamp) {
+                m_sent = stamp;
+                m_has_sent = true;
+                m_sent_now = true;
+            }
+            // Get the stamp a result made now should carry: the
+            // earliest consumed since the last call that sent, else
+            // that of the last result sent.  A node which buffers
+            // input or spreads one input over many calls thus passes
+            // on the stamp of its input.  False for a source.
+            bool origin(Stamp& stamp) {
+                if (m_has_origin) {
+                    stamp = m_origin;
+                    return true;
+                }
+                if (m_has_sent and !input_ports().empty()) {
+                    stamp = m_sent;
+                    return true;
+                }
+                return false;
+            }
+            // Get the earliest stamp consumed and not yet sent on.
+            bool unsent(Stamp& stamp) {
+                if (m_has_origin) {
+                    stamp = m_origin;
+                }
+                return m_has_origin;
+            }
+            // Called before each call.
+            void reset_origin() {
+                if (m_sent_now) {
+                    m_has_origin = false;
+                    m_sent_now = false;
+                }
+            }
+
         protected:
             // Concrete class should fill during construction
             PortList m_ports[Port::ntypes];
+
+        private:
+            Stamp m_origin, m_sent;
+            bool m_has_origin, m_has_sent, m_sent_now;
         };
     }
 }
@@ -0,0 +1,51 @@
+/** Per-thread performance counters read through Linux
+    perf_event_open(2).  Hardware events (cycles, instructions, cache
+    misses) are used when the kernel allows them, otherwise software
+    events (task clock, page faults).  Context switches are counted
+    in either case.  Elsewhere, or if no events may be opened, no
+    counters are provided.
+ */
+
+#ifndef WIRECELL_PGRAPH_PERFCOUNTERS
+#define WIRECELL_PGRAPH_PERFCOUNTERS
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace WireCell {
+    namespace Pgraph {
+
+        class PerfCounters {
+        public:
+            // Open counters for the calling thread.  They must only
+            // be read from that thread.
+            PerfCounters();
+            ~PerfCounters();
+
+            // Return the calling thread's counters, opened on first
+            // use.
+            static PerfCounters& thread_counters();
+
+            // Names of counters, empty if none could be opened.
+            const std::vector<std::string>& names() const { return m_names; }
+
+            // True if hardware events are counted.
+            bool hardware() const { return m_hardware; }
+
+            // Fill vals with current counts in order of names().
+            void read(std::vector<uint64_t>& vals);
+
+        private:
+            bool open(const std::vector<std::pair<uint32_t, uint64_t> >& events);
+            void close();
+
+            std::vector<int> m_fds;
+            std::vector<std::string> m_names;
+            std::vector<uint64_t> m_buf;
+            bool m_hardware;
+        };
+
+    }
+}
+#endif
@@ -46,6 +46,146 @@
     As when configuraing a component itself, the name need only be
     specified in an edge pair if not using the default (empty string).
 
+    The "engine" may be "push" (default) to repeatedly call nodes
+    from the bottom of the graph up, "pull" to have sinks demand
+    data which is then produced only as far upstream as needed or
+    "sdf" which is like "push" but where connected nodes with rates
+    fixed at configure time (Function, Join, Split, Fanin, Fanout,
+    Sink) are run from a precomputed static schedule.
+
+    Any edge may be "tapped" to record the data passing along it to a
+    file by giving its tail endpoint in the "taps" list.  A recording
+    may be "replayed" into the port of a node given in the "replays"
+    list, in which case no edge may also lead to that port.  This
+    allows a part of a graph to be benchmarked in isolation:
+
+      taps: [{tail:{node:wc.tn(sim)}, file:"frames.bin"}],
+      ...
+      replays: [{head:{node:wc.tn(sigproc)}, file:"frames.bin"}],
+
+    Function nodes which always give the same output for the same
+    input may have their outputs cached on disk across jobs by
+    listing them in "cache.nodes".  Each entry gives the node and its
+    configuration object, which is hashed into the cache key:
+
+      cache: { dir:"pgraph-cache", maxbytes:1e10,
+               nodes:[{node:wc.tn(sim), config:sim.data}] },
+
+    The config is required and must be the same as the "data" the
+    component is configured with, else outputs cached for an older
+    configuration would be returned.
+
+    After execution, any data left stuck in the graph is reported
+    unless "diagnose" is false.  Setting "watchdog" to a number of
+    seconds warns whenever no node makes progress for that long.
+
+    Setting "latency" to true reports the time from when data leaves
+    a source to when it is consumed by each sink as percentiles.
+    Setting "statistics" to true reports the number of calls and time
+    spent in each node and "counters" adds CPU event counts such as
+    cycles, instructions and cache misses where the kernel allows.
+    Setting "allocations" adds per node heap allocation counts, bytes
+    and peak, which requires libWireCellPgraphAlloc to be preloaded.
+
+    Part of a graph may be run by listing nodes, usually sinks, in
+    "targets".  Only they and the nodes upstream of them are run and
+    data they send to other nodes is dropped as it is made:
+
+      targets: [wc.tn(sigproc_sink)],
+
+    For near-online running data may be shed rather than fall behind.
+    Each tail endpoint listed in "shed.edges", usually of a source, gets
+    a Shedder.  While the latency to the sinks exceeds "shed.latency"
+    seconds, or any edge holds more than "shed.depth" data, it passes
+    only one in every "shed.prescale" data, or none if that is zero:
+
+      shed: {edges:[{node:wc.tn(source)}], latency:2.0, prescale:10},
+
+    With a prescale of zero, one datum is still passed each
+    "shed.latency" seconds while over that limit so the latency can
+    be measured again.
+    End-of-stream is always passed.  The number shed at each edge is
+    reported after execution.
+
+    Setting "prepare" to true calls prepare() on every node which
+    implements IPreparable, all at once on a pool of "threads"
+    threads, before executing the graph.  Setting "share_pool" to
+    true gives that same pool to every node implementing IContextual
+    so parallel work inside nodes draws on one set of workers instead
+    of each node starting its own threads.  Setting "buffers.enable"
+    gives them a BufferPool through which large buffers dropped at a
+    sink are reused by a source instead of reallocated each event.
+
+    A host application may exchange data with a long-lived graph
+    directly, instead of through ISourceNode and ISinkNode
+    components, through named ports listed in "ingress" (each with a
+    "head" endpoint) and "egress" (each with a "tail" endpoint).  See
+    graph().
+
+    Several Pgraphers in one job may run their graphs at the same
+    time, instead of one after another, by naming the same
+    "executor".  The first of them to execute runs all the graphs on
+    one pool of workers, giving each a share in proportion to its
+    "weight", and the others then only report:
+
+      { type:"Pgrapher", name:"sim", data:{ executor:"main", weight:1, ...}},
+      { type:"Pgrapher", name:"reco", data:{ executor:"main", weight:2, ...}},
+
+    Each graph is stepped its own "quantum" node calls at a time.
+    Smaller steps share workers more finely at some cost in overhead.
+
+    Long jobs may be watched while running by setting "metrics.file"
+    to a local file to which node rates, busy fractions and edge
+    depths are written every "metrics.interval" seconds, as JSON or,
+    with "metrics.format" set to "prometheus", as text for a local
+    scraper.
+
+    Setting "dot" to a file name writes the graph for GraphViz, with
+    measured busy time, counts and peak edge depths and the busiest
+    path in red once it has run:
+
+      dot -Tsvg -o graph.svg graph.dot
+
+    Setting "checkpoint.file" lets a preempted job continue where it
+    left off.  The data on all edges and the state of nodes which
+    implement ICheckpointable, or Replayer, is written to the file
+    between node calls every "checkpoint.interval" seconds.  A later
+    run of the same configuration resumes from the file if it exists.
+    The file is removed once a run completes.  Every source must
+    implement ICheckpointable as one which can not would repeat data
+    on resume.  A file written by a Recorder tap only holds what
+    passed after the resume.
+
+    Setting "profile" to a file name saves the busy time of each node
+    after execution.  Setting "autotune.overlay" writes settings tuned
+    to such a profile, given in "autotune.profile" without running the
+    graph or else measured from this run, for merging over this
+    configuration.  See Autotune.  The overlay only sets "threads"
+    if "prepare", "share_pool" or "executor" is set as otherwise no
+    pool is used.
+
+    To use more cores than one process can, the graph may be split
+    over local processes by listing node typenames in "shards":
+
+      shards: [[wc.tn(depos), wc.tn(sim)], [wc.tn(sigproc)], ...],
+
+    The first shard runs in this process.  Edges between shards carry
+    serialized data over UNIX sockets and each shard runs the push
+    engine.  A shard given as an object may be pinned to a set of
+    CPUs and have its memory, including that of its edges, placed on
+    a NUMA node:
+
+      shards: [{nodes:[wc.tn(sim)], cpus:"0-15", numa:0},
+               {nodes:[wc.tn(sigproc)], cpus:"16-31", numa:1}],
+
+    With "share_pool" each shard makes its own pool, sized by
+    "threads" or else by its number of CPUs or, with none given, an
+    equal share of the machine's.  Per shard statistics,
+    including the number of data received from another NUMA domain,
+    are reported after execution.  Child shards exit without
+    destroying their components so sinks must finish their output on
+    end-of-stream.
+
  */
 
 #ifndef WIRECELL_PGRAPH_PGRAPHER
@@ -55,6 +195,12 @@
 #include "WireCellIface/IConfigurable.h"
 #include "WireCellUtil/Logging.h"
 #include "WireCellPgraph/Graph.h"
+#include "WireCellPgraph/Cache.h"
+#include "WireCellPgraph/Shard.h"
+#include "WireCellPgraph/Autotune.h"
+#include "WireCellPgraph/Shedding.h"
+
+#include <memory>
 
 namespace WireCell {
     namespace Pgraph {
@@ -70,8 +216,37 @@ namespace WireCell {
             // IConfigurable
             virtual void configure(const WireCell::Configuration& config);
             virtual WireCell::Configuration default_configuration() const;
+
+            // Access the configured graph, eg for a host to push()
+            // to and pull() from its "ingress" and "egress" ports and
+            // to step() it instead of calling execute().
+            Graph& graph() { return m_graph; }
         private:
+            ThreadPool& pool();
+            // Ready nodes for execution.
+            void setup();
+            void execute_shards();
+            // Return an overlay tuned to the profile.
+            WireCell::Configuration tune(const WireCell::Configuration& profile);
+            // Log what was asked for after execution.
+            void report();
+            void write_dot();
+
             Graph m_graph;
+            std::string m_engine, m_executor, m_dot, m_checkpoint;
+            bool m_diagnose, m_statistics, m_prepare, m_share_pool, m_resume;
+            int m_nthreads;
+            // Made on first use by pool(), or that of the executor.
+            std::shared_ptr<ThreadPool> m_pool;
+            // Wrapping nodes owned by the graph, kept for their counts.
+            std::vector<CachedFunction*> m_cached;
+            std::vector<Shedder*> m_shedders;
+            std::shared_ptr<DiskCache> m_cache;
+            std::shared_ptr<BufferPool> m_buffers;
+            std::unique_ptr<Sharding> m_sharding;
+            NodeNames m_names;
+            std::string m_profile, m_overlay, m_tune_profile;
+            int m_tune_shards;
             Log::logptr_t l;
         };
     }
@@ -5,6 +5,7 @@
 
 #include <boost/any.hpp>
 
+#include <chrono>
 #include <string>
 #include <vector>
 #include <deque>
@@ -26,6 +27,12 @@ namespace WireCell {
         // Edges are just queues that can be shared.
         typedef std::shared_ptr<Queue> Edge;
 
+        // Optionally, an edge may carry in parallel to its data the
+        // time at which the earliest source datum that contributed
+        // to each datum was produced.
+        typedef std::chrono::steady_clock::time_point Stamp;
+        typedef std::shared_ptr<std::deque<Stamp> > Stamps;
+
         class Node;
 
         class Port {
@@ -41,6 +48,9 @@ namespace WireCell {
             // Connect an edge, returning any previous one.
             Edge plug(Edge edge);
 
+            // Connect the stamps carried along side the edge.
+            void plug_stamps(Stamps stamps);
+
             // return edge queue size or 0 if no edge has been plugged
             size_t size();
 
@@ -53,6 +63,15 @@ namespace WireCell {
 
             // Put the data onto the queue.
             void put(Data& data);
+            // Move the data onto the queue.
+            void put(Data&& data);
+
+            // Make put() drop all data, for an output whose
+            // downstream is not run.
+            void discard() { m_discard = true; }
+
+            // The most data an output port has left on its edge.
+            size_t peak() const { return m_peak; }
 
 	    // Get back the associated Node.
 	    Node* node();
@@ -65,6 +84,9 @@ namespace WireCell {
             Type m_type;
             std::string m_name, m_sig;
             Edge m_edge;
+            Stamps m_stamps;
+            size_t m_peak;
+            bool m_discard;
         };
 
         typedef std::vector<Port> PortList;
@@ -0,0 +1,68 @@
+/** Nodes to record the data passing along an edge to a file and to
+    replay such a file as a source.  This allows part of a graph to be
+    run repeatedly on identical input without the cost of running the
+    nodes upstream of it.
+
+    The data is written with the serializer found for the signature
+    of the recorded edge.  See Serializer.h.
+ */
+
+#ifndef WIRECELL_PGRAPH_RECORDING
+#define WIRECELL_PGRAPH_RECORDING
+
+#include "WireCellPgraph/Node.h"
+#include "WireCellPgraph/Serializer.h"
+
+#include <fstream>
+
+namespace WireCell {
+    namespace Pgraph {
+
+        // A pass-through node which writes each datum to a file.
+        class Recorder : public Node {
+        public:
+            Recorder(const std::string& signature, const std::string& filename);
+            virtual ~Recorder();
+
+            virtual bool operator()();
+            virtual std::string ident();
+            virtual size_t rate(Port::Type /*type*/, size_t /*ind*/=0) {
+                return 1;
+            }
+            virtual bool fire();
+
+        private:
+            std::string m_filename;
+            std::ofstream m_out;
+            Serializer* m_ser;
+        };
+
+        // A source node producing the data recorded in a file.
+        class Replayer : public Node {
+        public:
+            // If preload is true, the file is read fully on
+            // construction so replaying is not slowed by reading.
+            Replayer(const std::string& filename, bool preload=true);
+            virtual ~Replayer();
+
+            virtual bool operator()();
+            virtual std::string ident();
+
+            // The state is the number of data given.
+            virtual bool save_state(std::string& state);
+            virtual void load_state(const std::string& state);
+
+        private:
+            bool next(Data& data);
+
+            std::string m_filename;
+            std::ifstream m_in;
+            Serializer* m_ser;
+            Queue m_loaded;
+            bool m_preload;
+            size_t m_given;
+        };
+
+    }
+}
+#endif
@@ -0,0 +1,69 @@
+/** Serializers convert the Data carried by an edge to and from a
+    byte stream.  They are found by port signature, which is the
+    typeid name of the data type, so any edge may be written and read
+    back as long as a serializer for its type has been bound.
+
+    Serializers write to local, short-lived files meant to be read by
+    the same build of the software.  No attempt is made at a portable
+    or versioned format.
+ */
+
+#ifndef WIRECELL_PGRAPH_SERIALIZER
+#define WIRECELL_PGRAPH_SERIALIZER
+
+#include "WireCellPgraph/Port.h"
+
+#include <iostream>
+#include <map>
+#include <memory>
+#include <typeinfo>
+
+namespace WireCell {
+    namespace Pgraph {
+
+        struct Serializer {
+            virtual ~Serializer() {}
+
+            // Write one datum to the stream.
+            virtual void write(std::ostream& so, const Data& data) = 0;
+
+            // Read one datum from the stream.  Throws IOError if
+            // the stream ends or is bad.
+            virtual Data read(std::istream& si) = 0;
+
+            // Return true if the datum marks end-of-stream.
+            virtual bool eos(const Data& data) = 0;
+        };
+
+        // Registry of serializers by port signature.  The data types
+        // defined by WireCellIface which commonly flow through a
+        // graph are bound on construction.
+        class Serializers {
+        public:
+            static Serializers& instance();
+
+            template<class DataType>
+            void bind(Serializer* ser) {
+                m_sers[typeid(DataType).name()].reset(ser);
+            }
+
+            // Return serializer for the signature or nullptr.
+            Serializer* find(const std::string& signature);
+
+            // As find() but throw ValueError if missing.
+            Serializer* get(const std::string& signature);
+
+        private:
+            Serializers();
+            std::map<std::string, std::unique_ptr<Serializer> > m_sers;
+        };
+
+        // Write a stream header recording the signature.
+        void write_header(std::ostream& so, const std::string& signature);
+
+        // Read a stream header and return its signature.
+        std::string read_header(std::istream& si);
+
+    }
+}
+#endif
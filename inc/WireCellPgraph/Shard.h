@@ -0,0 +1,178 @@
+/** Run one graph as several local processes.
+
+    Every node is assigned to a shard.  Shard zero runs in the calling
+    process and each other shard runs in a child process forked from
+    it at execution time, after all components have been configured,
+    so no component needs to know it is being sharded.
+
+    Each edge between nodes in different shards is replaced by a
+    ShardSender in the tail shard and a ShardReceiver in the head
+    shard connected by a UNIX socket.  Data crossing the socket is
+    written with the serializer for the edge signature.  A reader
+    thread per receiver always drains its socket, so a sender never
+    waits on a stalled peer.  A sender closes its socket once the
+    shard is idle and every receiver upstream of it has drained, so
+    end of input propagates from shard to shard.  As the graph itself
+    is acyclic this finishes even where data passes back and forth
+    between two shards.
+
+    All shards run on the local host and nothing is shared between
+    processes except the sockets carrying data and statistics.
+
+    A shard may be placed on a set of CPUs and a NUMA memory node
+    before it starts so that its threads and the data on its edges
+    stay in one domain.  Data received from a shard in another domain
+    is counted as having crossed.  The calling process gets back its
+    own CPUs and memory policy once shard zero finishes.
+ */
+
+#ifndef WIRECELL_PGRAPH_SHARD
+#define WIRECELL_PGRAPH_SHARD
+
+#include "WireCellPgraph/Graph.h"
+#include "WireCellPgraph/Serializer.h"
+#include "WireCellUtil/Configuration.h"
+#include "WireCellUtil/Logging.h"
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace WireCell {
+    namespace Pgraph {
+
+        // Wakes a shard waiting for any of its receivers.
+        struct ShardSignal {
+            std::mutex mutex;
+            std::condition_variable cond;
+            size_t arrivals{0};
+        };
+
+        // A sink writing each datum to a socket.
+        class ShardSender : public Node {
+        public:
+            ShardSender(const std::string& signature, int fd);
+            virtual ~ShardSender();
+
+            virtual bool operator()();
+            virtual std::string ident();
+            virtual size_t rate(Port::Type /*type*/, size_t /*ind*/=0) {
+                return 1;
+            }
+            virtual bool fire();
+
+            // Close the socket, telling the peer nothing more comes.
+            void close();
+            bool closed() const { return m_fd < 0; }
+
+            size_t count() const { return m_count; }
+
+        private:
+            int m_fd;
+            Serializer* m_ser;
+            size_t m_count;
+        };
+
+        // A source producing the data read from a socket.
+        class ShardReceiver : public Node {
+        public:
+            ShardReceiver(const std::string& signature, int fd,
+                          ShardSignal& signal);
+            virtual ~ShardReceiver();
+
+            virtual bool operator()();
+            virtual std::string ident();
+
+            // True if nothing has arrived to give but the peer may
+            // yet send more.
+            bool starved();
+
+            // True once the peer has closed and all data is given.
+            bool drained();
+
+            size_t count() const { return m_count; }
+
+        private:
+            void run();
+
+            int m_fd;
+            Serializer* m_ser;
+            ShardSignal& m_signal;
+            std::mutex m_mutex;
+            Queue m_inbox;
+            bool m_closed;
+            size_t m_count;
+            std::thread m_thread;
+        };
+
+        // Where to run a shard.
+        struct ShardPlacement {
+            std::vector<int> cpus;  // empty for any
+            int numa{-1};           // memory node, -1 for any
+        };
+
+        class Sharding {
+        public:
+            // The assignment gives a shard number for some nodes of
+            // the graph.  Other nodes join the shard of a connected
+            // assigned node or else shard zero.  Throws ValueError if
+            // an edge between shards has no serializer.
+            Sharding(Graph& graph, const std::unordered_map<Node*, int>& assignment);
+
+            size_t size() const { return m_nshards; }
+
+            // Set where the shard runs.  The shard must exist.
+            void place(int shard, const ShardPlacement& placement);
+
+            // Return the NUMA domain of a shard: its memory node, else
+            // that of its first CPU, else -1.
+            int domain(int shard) const;
+
+            // If nonnegative, each shard gives its nodes a Context
+            // with its own pool of this many workers, zero meaning
+            // one per CPU the shard is pinned to or, if not pinned,
+            // an equal share of the machine's.  Default is -1.
+            void set_threads(int nthreads) { m_nthreads = nthreads; }
+
+            // Give each shard's nodes a Context with this buffer
+            // pool, which each shard then has its own copy of.
+            void set_buffers(std::shared_ptr<BufferPool> buffers) { m_buffers = buffers; }
+
+            // Have each shard write metrics, see Graph::set_metrics().
+            // Shards other than zero insert "-shard<N>" before any
+            // extension of the file name.
+            void set_metrics(const std::string& filename, double interval,
+                             const std::string& format);
+
+            // Number of edges between shards.
+            size_t crossings() const { return m_cross.size(); }
+
+            // Fork the other shards, run shard zero here and wait for
+            // all to finish.  Return statistics as {shards:[{shard,
+            // pid, status, domain, nodes, calls, fired, seconds,
+            // stalled, sent, received, crossed, stats}]}.  The edges
+            // of the graph are left as they were found.
+            WireCell::Configuration execute();
+
+        private:
+            // Build and run one shard on the given sockets, one pair
+            // per crossing edge, and return its statistics.
+            WireCell::Configuration run(int shard, const std::vector<int>& fds);
+
+            Graph& m_graph;
+            std::unordered_map<Node*, int> m_shard;
+            size_t m_nshards;
+            int m_nthreads;
+            std::shared_ptr<BufferPool> m_buffers;
+            std::string m_metrics, m_metrics_format;
+            double m_metrics_interval;
+            std::vector<ShardPlacement> m_placement;
+            // Indices into graph edges which cross shards.
+            std::vector<size_t> m_cross;
+            Log::logptr_t l;
+        };
+
+    }
+}
+#endif
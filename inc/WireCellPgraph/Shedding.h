@@ -0,0 +1,64 @@
+/** Shed load to keep up with input instead of falling behind.
+
+    A Shedder is placed on an edge leaving a source.  While the graph
+    is over a limit of its policy, on the latency of data reaching
+    the sinks or on the depth of any edge, it passes only one in every
+    "prescale" data, or none.  Latency is only measured as data
+    reaches a sink, so when passing none while over the latency limit
+    a probe datum is passed if none has been for as long as that
+    limit, letting the measure recover.  End-of-stream always passes
+    so the graph still finishes cleanly.  Data is only ever dropped
+    by a Shedder and each counts exactly what it dropped.
+ */
+
+#ifndef WIRECELL_PGRAPH_SHEDDING
+#define WIRECELL_PGRAPH_SHEDDING
+
+#include "WireCellPgraph/Graph.h"
+#include "WireCellPgraph/Serializer.h"
+
+#include <chrono>
+
+namespace WireCell {
+    namespace Pgraph {
+
+        // When and how much to shed.  A limit of zero is not applied.
+        struct ShedPolicy {
+            // Seconds from a source to a sink of the latest datum to
+            // arrive.  Needs Graph::enable_latency().
+            double latency{0};
+            // Data waiting on any one edge.
+            size_t depth{0};
+            // While over a limit pass one in this many, zero for none.
+            size_t prescale{0};
+        };
+
+        // A pass-through node shedding data while the graph is over
+        // a limit.  The signature must have a serializer, which is
+        // used to recognize end-of-stream.
+        class Shedder : public Node {
+        public:
+            Shedder(const std::string& signature, Graph& graph,
+                    const ShedPolicy& policy);
+            virtual ~Shedder();
+
+            virtual bool operator()();
+            virtual std::string ident();
+
+            size_t passed() const { return m_passed; }
+            size_t shed() const { return m_shed; }
+
+        private:
+            bool overloaded();
+            bool probe_due(std::chrono::steady_clock::time_point now);
+
+            Graph& m_graph;
+            ShedPolicy m_policy;
+            Serializer* m_ser;
+            size_t m_passed, m_shed, m_over;
+            std::chrono::steady_clock::time_point m_last_pass;
+        };
+
+    }
+}
+#endif
@@ -0,0 +1,173 @@
+/** Synthetic nodes for load testing the graph engine.
+
+    There is one node for each category bound by Pgraph::Factory.
+    They pass frames which carry nothing but a payload of samples and
+    spend a configured amount of CPU time in each call so that any
+    graph shape may be run through Pgrapher from a configuration
+    without the cost or noise of physics components:
+
+      SynthSource -> SynthFanout -> SynthFunction... -> SynthFanin
+        -> SynthQueuedout -> SynthSplit -> SynthJoin -> SynthHydra
+        -> SynthSink
+
+    All take these configuration parameters:
+
+    - cpu :: seconds of CPU time to spend in each call.
+    - payload :: number of samples in each frame made, or zero to
+      pass on the first input as is.
+    - multiplicity :: number of outputs per input of a SynthQueuedout
+      and number of ports of the others with many.
+    - count :: number of frames per stream from a SynthSource.
+    - streams :: number of streams from a SynthSource, each ended by
+      end-of-stream.
+    - inputs, outputs :: number of ports of a SynthHydra.
+    - concurrency :: as reported to the engine.
+
+    End-of-stream (a null frame) is passed on as soon as it arrives.
+ */
+
+#ifndef WIRECELL_PGRAPH_SYNTHETIC
+#define WIRECELL_PGRAPH_SYNTHETIC
+
+#include "WireCellIface/IConfigurable.h"
+#include "WireCellIface/IFrame.h"
+#include "WireCellIface/ISourceNode.h"
+#include "WireCellIface/ISinkNode.h"
+#include "WireCellIface/IFunctionNode.h"
+#include "WireCellIface/IQueuedoutNode.h"
+#include "WireCellIface/IJoinNode.h"
+#include "WireCellIface/ISplitNode.h"
+#include "WireCellIface/IFanoutNode.h"
+#include "WireCellIface/IFaninNode.h"
+#include "WireCellIface/IHydraNode.h"
+
+namespace WireCell {
+    namespace Pgraph {
+
+        // The configuration and work common to synthetic nodes.
+        class Synthetic : public WireCell::IConfigurable {
+        public:
+            Synthetic();
+            virtual ~Synthetic();
+
+            virtual void configure(const WireCell::Configuration& cfg);
+            virtual WireCell::Configuration default_configuration() const;
+
+        protected:
+            // Spend the configured CPU time.
+            void burn();
+
+            // Return a new frame with the payload or, if the payload
+            // is zero, the given one.  Null in gives null out.
+            IFrame::pointer make(const boost::any& in);
+
+            // Return a new frame with the payload.
+            IFrame::pointer make();
+
+            // Types of num ports.
+            std::vector<std::string> types(size_t num);
+
+            static bool eos(const boost::any& in);
+
+            double m_cpu;
+            size_t m_payload, m_multiplicity, m_count, m_streams;
+            size_t m_inputs, m_outputs;
+            int m_concurrency;
+            int m_ident;
+        };
+
+        class SynthSource : public Synthetic, public ISourceNodeBase {
+        public:
+            virtual ~SynthSource() {}
+            virtual std::string signature() { return typeid(SynthSource).name(); }
+            virtual int concurrency() { return m_concurrency; }
+            virtual std::vector<std::string> output_types() { return types(1); }
+            virtual bool operator()(boost::any& anyout);
+        private:
+            size_t m_made{0}, m_ended{0};
+        };
+
+        class SynthSink : public Synthetic, public ISinkNodeBase {
+        public:
+            virtual ~SynthSink() {}
+            virtual std::string signature() { return typeid(SynthSink).name(); }
+            virtual int concurrency() { return m_concurrency; }
+            virtual std::vector<std::string> input_types() { return types(1); }
+            virtual bool operator()(const boost::any& anyin);
+        };
+
+        class SynthFunction : public Synthetic, public IFunctionNodeBase {
+        public:
+            virtual ~SynthFunction() {}
+            virtual std::string signature() { return typeid(SynthFunction).name(); }
+            virtual int concurrency() { return m_concurrency; }
+            virtual std::vector<std::string> input_types() { return types(1); }
+            virtual std::vector<std::string> output_types() { return types(1); }
+            virtual bool operator()(const boost::any& anyin, boost::any& anyout);
+        };
+
+        class SynthQueuedout : public Synthetic, public IQueuedoutNodeBase {
+        public:
+            virtual ~SynthQueuedout() {}
+            virtual std::string signature() { return typeid(SynthQueuedout).name(); }
+            virtual int concurrency() { return m_concurrency; }
+            virtual std::vector<std::string> input_types() { return types(1); }
+            virtual std::vector<std::string> output_types() { return types(1); }
+            virtual bool operator()(const boost::any& anyin, queuedany& outanyq);
+        };
+
+        class SynthJoin : public Synthetic, public IJoinNodeBase {
+        public:
+            virtual ~SynthJoin() {}
+            virtual std::string signature() { return typeid(SynthJoin).name(); }
+            virtual int concurrency() { return m_concurrency; }
+            virtual std::vector<std::string> input_types() { return types(m_multiplicity); }
+            virtual std::vector<std::string> output_types() { return types(1); }
+            virtual bool operator()(const any_vector& anyins, boost::any& anyout);
+        };
+
+        class SynthFanin : public Synthetic, public IFaninNodeBase {
+        public:
+            virtual ~SynthFanin() {}
+            virtual std::string signature() { return typeid(SynthFanin).name(); }
+            virtual int concurrency() { return m_concurrency; }
+            virtual std::vector<std::string> input_types() { return types(m_multiplicity); }
+            virtual std::vector<std::string> output_types() { return types(1); }
+            virtual bool operator()(const any_vector& anyins, boost::any& anyout);
+        };
+
+        class SynthSplit : public Synthetic, public ISplitNodeBase {
+        public:
+            virtual ~SynthSplit() {}
+            virtual std::string signature() { return typeid(SynthSplit).name(); }
+            virtual int concurrency() { return m_concurrency; }
+            virtual std::vector<std::string> input_types() { return types(1); }
+            virtual std::vector<std::string> output_types() { return types(m_multiplicity); }
+            virtual bool operator()(const boost::any& anyin, any_vector& anyouts);
+        };
+
+        class SynthFanout : public Synthetic, public IFanoutNodeBase {
+        public:
+            virtual ~SynthFanout() {}
+            virtual std::string signature() { return typeid(SynthFanout).name(); }
+            virtual int concurrency() { return m_concurrency; }
+            virtual std::vector<std::string> input_types() { return types(1); }
+            virtual std::vector<std::string> output_types() { return types(m_multiplicity); }
+            virtual bool operator()(const boost::any& anyin, any_vector& anyouts);
+        };
+
+        // Consumes one from each input at a time and gives one to
+        // each output.
+        class SynthHydra : public Synthetic, public IHydraNodeBase {
+        public:
+            virtual ~SynthHydra() {}
+            virtual std::string signature() { return typeid(SynthHydra).name(); }
+            virtual int concurrency() { return m_concurrency; }
+            virtual std::vector<std::string> input_types() { return types(m_inputs); }
+            virtual std::vector<std::string> output_types() { return types(m_outputs); }
+            virtual bool operator()(any_queue_vector& anyinq, any_queue_vector& anyoutq);
+        };
+
+    }
+}
+#endif
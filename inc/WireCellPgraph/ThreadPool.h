@@ -0,0 +1,54 @@
+/** A simple fixed size pool of worker threads.
+
+    Work given to parallel_for() is also done by the calling thread so
+    it may be called from within a task running on the pool without
+    risk of every worker waiting on work that no thread is free to do.
+ */
+
+#ifndef WIRECELL_PGRAPH_THREADPOOL
+#define WIRECELL_PGRAPH_THREADPOOL
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace WireCell {
+    namespace Pgraph {
+
+        class ThreadPool {
+        public:
+            // Start nthreads workers, zero means one per hardware
+            // thread.
+            explicit ThreadPool(size_t nthreads=0);
+            ~ThreadPool();
+
+            ThreadPool(const ThreadPool&) = delete;
+            ThreadPool& operator=(const ThreadPool&) = delete;
+
+            // Number of worker threads.
+            size_t size() const { return m_workers.size(); }
+
+            // Queue a task to run on some worker.
+            void submit(std::function<void()> task);
+
+            // Call func(ind) for each ind in [0,num) and return when
+            // all are done.  The first exception thrown by func is
+            // rethrown after all calls finish.
+            void parallel_for(size_t num, std::function<void(size_t)> func);
+
+        private:
+            void work();
+
+            std::vector<std::thread> m_workers;
+            std::deque<std::function<void()> > m_tasks;
+            std::mutex m_mutex;
+            std::condition_variable m_cv;
+            bool m_stop;
+        };
+
+    }
+}
+#endif
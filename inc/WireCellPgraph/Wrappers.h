@@ -2,6 +2,10 @@
 #define WIRECELL_PGRAPH_WRAPPERS
 
 #include "WireCellPgraph/Graph.h"
+#include "WireCellPgraph/IPreparable.h"
+#include "WireCellPgraph/IContextual.h"
+#include "WireCellPgraph/ICheckpointable.h"
+#include "WireCellPgraph/IStreaming.h"
 
 // fixme: this is a rather monolithic file that should be broken out
 // into its own package.  It needs to depend on util and iface but NOT
@@ -18,6 +22,7 @@
 
 #include "WireCellUtil/Type.h"
 
+#include <algorithm>
 #include <map>
 #include <iostream>             // debug
 #include <sstream>
@@ -72,6 +77,38 @@ namespace WireCell { namespace Pgraph {
                 return ss.str();
             }
 
+            virtual void prepare() {
+                auto prep = std::dynamic_pointer_cast<IPreparable>(m_wcnode);
+                if (prep) {
+                    prep->prepare();
+                }
+            }
+
+            virtual void set_context(const Context& ctx) {
+                auto ctxl = std::dynamic_pointer_cast<IContextual>(m_wcnode);
+                if (ctxl) {
+                    ctxl->set_context(ctx);
+                }
+            }
+
+            // A source which can not save its place would repeat
+            // what it made before on resume and so is never safe.
+            virtual bool save_state(std::string& state) {
+                auto ckpt = std::dynamic_pointer_cast<ICheckpointable>(m_wcnode);
+                if (ckpt) {
+                    state = ckpt->save_state();
+                    return true;
+                }
+                return m_wcnode->category() != INode::sourceNode;
+            }
+
+            virtual void load_state(const std::string& state) {
+                auto ckpt = std::dynamic_pointer_cast<ICheckpointable>(m_wcnode);
+                if (ckpt) {
+                    ckpt->load_state(state);
+                }
+            }
+
         private:
             INode::pointer m_wcnode;
         };
@@ -114,7 +151,13 @@ namespace WireCell { namespace Pgraph {
                 if (ip.empty()) {
                     return false; // don't call me if there is nothing to give me.
                 }
-                auto obj = ip.get();
+                return fire();
+            }
+            virtual size_t rate(Port::Type /*type*/, size_t /*ind*/=0) {
+                return 1;
+            }
+            virtual bool fire() {
+                auto obj = iport().get();
                 bool ok = (*m_wcnode)(obj);
                 //std::cerr << "Sink returns: " << ok << std::endl;
                 return ok;
@@ -137,25 +180,39 @@ namespace WireCell { namespace Pgraph {
                 if (ip.empty()) {
                     return false; // don't call me if there is nothing to give me.
                 }
+                return fire();
+            }
+            virtual size_t rate(Port::Type /*type*/, size_t /*ind*/=0) {
+                return 1;
+            }
+            virtual bool fire() {
                 boost::any out;
-                auto in = ip.get();
+                auto in = iport().get();
                 bool ok = (*m_wcnode)(in, out);
                 if (!ok) {
                     return false;
                 }
-                op.put(out);
+                oport().put(out);
                 return true;
             }
         };
 
+        // If the node implements IStreaming its outputs are asked
+        // for a chunk at a time, else all at once.
         class Queuedout : public PortedNode {
             IQueuedoutNodeBase::pointer m_wcnode;
+            std::shared_ptr<IStreaming> m_stream;
+            bool m_streaming;
         public:
-            Queuedout(INode::pointer wcnode) : PortedNode(wcnode) {
+            Queuedout(INode::pointer wcnode) : PortedNode(wcnode), m_streaming(false) {
                 m_wcnode = std::dynamic_pointer_cast<IQueuedoutNodeBase>(wcnode);
+                m_stream = std::dynamic_pointer_cast<IStreaming>(wcnode);
             }
             virtual ~Queuedout() {}
             virtual bool operator()() {
+                if (m_stream) {
+                    return stream();
+                }
                 Port& ip = iport();
                 if (ip.empty()) { return false; }
                 IQueuedoutNodeBase::queuedany outv;
@@ -167,6 +224,35 @@ namespace WireCell { namespace Pgraph {
                 }
                 return true;
             }
+
+            bool stream() {
+                Port& op = oport();
+                size_t chunk = std::max<size_t>(1, m_stream->chunk());
+                if (op.size() >= chunk) {
+                    return false; // let downstream catch up
+                }
+                bool began = false;
+                if (!m_streaming) {
+                    Port& ip = iport();
+                    if (ip.empty()) { return false; }
+                    if (!m_stream->begin(ip.get(false))) { return false; }
+                    ip.get();
+                    m_streaming = began = true;
+                }
+                IQueuedoutNodeBase::queuedany outv;
+                m_streaming = m_stream->next(outv, chunk - op.size());
+                for (auto out : outv) {
+                    op.put(out);
+                }
+                return began or !outv.empty() or !m_streaming;
+            }
+
+            virtual bool save_state(std::string& state) {
+                if (m_streaming) {
+                    return false; // the input being streamed is gone
+                }
+                return PortedNode::save_state(state);
+            }
         };
 
         template<class INodeBaseType>
@@ -193,6 +279,14 @@ namespace WireCell { namespace Pgraph {
                         return false;
                     }                        
                 }
+                return fire();
+            }
+            virtual size_t rate(Port::Type /*type*/, size_t /*ind*/=0) {
+                return 1;
+            }
+            virtual bool fire() {
+                auto& iports = input_ports();
+                size_t nin = iports.size();
                 any_vector inv(nin);
                 for (size_t ind=0; ind<nin; ++ind) {
                     inv[ind] = iports[ind].get();
@@ -202,7 +296,7 @@ namespace WireCell { namespace Pgraph {
                 if (!ok) {
                     return false;
                 }
-                op.put(out);
+                oport().put(out);
                 return true;                                      
             }
         private:
@@ -242,9 +336,16 @@ namespace WireCell { namespace Pgraph {
                 if (full) {
                     return false; // don't call me if all my output has something
                 }                
+                return fire();
+            }
+            virtual size_t rate(Port::Type /*type*/, size_t /*ind*/=0) {
+                return 1;
+            }
+            virtual bool fire() {
+                auto in = iport().get();
 
-                auto in = ip.get();
-
+                auto& oports = output_ports();
+                size_t nout = oports.size();
                 any_vector outv(nout);
                 bool ok = (*m_wcnode)(in, outv);
                 if (!ok) {
@@ -336,8 +437,9 @@ namespace WireCell { namespace Pgraph {
                 
                 // 5) send out output any queue vectors
                 for (size_t ind=0; ind < nout; ++ind) {
-                    Edge edge = oports[ind].edge();
-                    edge->insert(edge->end(), outqv[ind].begin(), outqv[ind].end());
+                    for (auto& out : outqv[ind]) {
+                        oports[ind].put(out);
+                    }
                 }
 
                 return true;
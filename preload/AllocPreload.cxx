@@ -0,0 +1,126 @@
+/** Replacement global operator new and delete which account heap
+    allocations for AllocTracker.
+
+    This is built as its own library, libWireCellPgraphAlloc, which
+    is only meant to be preloaded, eg with LD_PRELOAD, and is never
+    linked by libWireCellPgraph so that ordinary jobs keep the
+    standard library's operators.  Accounting relies on
+    malloc_usable_size() and so is only available with glibc.
+ */
+
+#include "WireCellPgraph/AllocTracker.h"
+
+#include <cstdlib>
+#include <new>
+
+#ifdef __GLIBC__
+
+#include <malloc.h>
+
+using WireCell::Pgraph::AllocStats;
+
+static thread_local AllocStats* t_stats = nullptr;
+static thread_local int64_t t_live = 0;
+
+// Found by AllocTracker, see there.
+extern "C" void wirecell_pgraph_alloc_attach(AllocStats* stats)
+{
+    t_live = 0;
+    t_stats = stats;
+}
+
+static void account_alloc(void* ptr)
+{
+    if (!t_stats or !ptr) {
+        return;
+    }
+    size_t size = malloc_usable_size(ptr);
+    ++t_stats->nallocs;
+    t_stats->alloc_bytes += size;
+    t_live += size;
+    if (t_live > t_stats->peak_bytes) {
+        t_stats->peak_bytes = t_live;
+    }
+}
+
+static void account_free(void* ptr)
+{
+    if (!t_stats or !ptr) {
+        return;
+    }
+    size_t size = malloc_usable_size(ptr);
+    ++t_stats->nfrees;
+    t_stats->free_bytes += size;
+    t_live -= size;
+}
+
+static void* tracked_new(size_t size, size_t align=0)
+{
+    if (!size) {
+        size = 1;
+    }
+    while (true) {
+        void* ptr = nullptr;
+        if (align) {
+            if (posix_memalign(&ptr, align, size)) {
+                ptr = nullptr;
+            }
+        }
+        else {
+            ptr = malloc(size);
+        }
+        if (ptr) {
+            account_alloc(ptr);
+            return ptr;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+static void* tracked_new_nothrow(size_t size, size_t align=0) noexcept
+{
+    try { return tracked_new(size, align); }
+    catch (...) { return nullptr; }
+}
+
+static void tracked_delete(void* ptr)
+{
+    account_free(ptr);
+    free(ptr);
+}
+
+void* operator new(size_t size) { return tracked_new(size); }
+void* operator new[](size_t size) { return tracked_new(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return tracked_new_nothrow(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return tracked_new_nothrow(size); }
+void operator delete(void* ptr) noexcept { tracked_delete(ptr); }
+void operator delete[](void* ptr) noexcept { tracked_delete(ptr); }
+void operator delete(void* ptr, size_t) noexcept { tracked_delete(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { tracked_delete(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { tracked_delete(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { tracked_delete(ptr); }
+
+#ifdef __cpp_aligned_new
+void* operator new(size_t size, std::align_val_t al) { return tracked_new(size, size_t(al)); }
+void* operator new[](size_t size, std::align_val_t al) { return tracked_new(size, size_t(al)); }
+void* operator new(size_t size, std::align_val_t al, const std::nothrow_t&) noexcept
+{
+    return tracked_new_nothrow(size, size_t(al));
+}
+void* operator new[](size_t size, std::align_val_t al, const std::nothrow_t&) noexcept
+{
+    return tracked_new_nothrow(size, size_t(al));
+}
+void operator delete(void* ptr, std::align_val_t) noexcept { tracked_delete(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { tracked_delete(ptr); }
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept { tracked_delete(ptr); }
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept { tracked_delete(ptr); }
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { tracked_delete(ptr); }
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { tracked_delete(ptr); }
+#endif
+
+#endif
@@ -0,0 +1,151 @@
+#include "WireCellPgraph/Affinity.h"
+#include "WireCellUtil/Exceptions.h"
+
+#ifdef __linux__
+#include <dirent.h>
+#include <linux/mempolicy.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <cstdlib>
+#include <sstream>
+
+using namespace WireCell;
+
+std::vector<int> Pgraph::parse_cpus(const std::string& spec)
+{
+    std::vector<int> cpus;
+    std::stringstream ss(spec);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (item.empty()) {
+            continue;
+        }
+        char* end = nullptr;
+        long beg = strtol(item.c_str(), &end, 10);
+        long last = beg;
+        if (*end == '-') {
+            last = strtol(end+1, &end, 10);
+        }
+        if (*end or beg < 0 or last < beg) {
+            THROW(ValueError() << errmsg{"bad CPU list: " + spec});
+        }
+        for (long cpu=beg; cpu<=last; ++cpu) {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+#ifdef __linux__
+
+bool Pgraph::pin_cpus(const std::vector<int>& cpus)
+{
+    if (cpus.empty()) {
+        return false;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) {
+        if (cpu >= CPU_SETSIZE) {
+            return false;
+        }
+        CPU_SET(cpu, &set);
+    }
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+}
+
+bool Pgraph::bind_numa(int node)
+{
+    const int nbits = 8*sizeof(unsigned long);
+    if (node < 0 or node >= nbits) {
+        return false;
+    }
+    unsigned long mask = 1UL << node;
+    return syscall(SYS_set_mempolicy, MPOL_PREFERRED, &mask, nbits) == 0;
+}
+
+int Pgraph::cpu_numa_node(int cpu)
+{
+    std::string dir = "/sys/devices/system/cpu/cpu" + std::to_string(cpu);
+    DIR* dp = opendir(dir.c_str());
+    if (!dp) {
+        return -1;
+    }
+    int node = -1;
+    while (struct dirent* de = readdir(dp)) {
+        std::string name = de->d_name;
+        if (name.size() > 4 and name.compare(0, 4, "node") == 0) {
+            node = atoi(name.c_str() + 4);
+            break;
+        }
+    }
+    closedir(dp);
+    return node;
+}
+
+// The kernel may be built for up to this many NUMA nodes.
+static const int max_numa_nodes = 1024;
+
+Pgraph::SavedPlacement::SavedPlacement()
+    : m_mode(-1)
+    , m_nodes(max_numa_nodes / (8*sizeof(unsigned long)), 0)
+{
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (int cpu=0; cpu<CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &set)) {
+                m_cpus.push_back(cpu);
+            }
+        }
+    }
+    int mode = 0;
+    if (syscall(SYS_get_mempolicy, &mode, m_nodes.data(), max_numa_nodes, 0, 0) == 0) {
+        m_mode = mode;
+    }
+}
+
+Pgraph::SavedPlacement::~SavedPlacement()
+{
+    if (!m_cpus.empty()) {
+        pin_cpus(m_cpus);
+    }
+    if (m_mode == MPOL_DEFAULT) {
+        syscall(SYS_set_mempolicy, MPOL_DEFAULT, nullptr, 0);
+    }
+    else if (m_mode >= 0) {
+        // The kernel reads one bit less than it is told.
+        syscall(SYS_set_mempolicy, m_mode, m_nodes.data(), max_numa_nodes + 1);
+    }
+}
+
+#else
+
+bool Pgraph::pin_cpus(const std::vector<int>& cpus)
+{
+    return false;
+}
+
+bool Pgraph::bind_numa(int node)
+{
+    return false;
+}
+
+int Pgraph::cpu_numa_node(int cpu)
+{
+    return -1;
+}
+
+Pgraph::SavedPlacement::SavedPlacement()
+    : m_mode(-1)
+{
+}
+
+Pgraph::SavedPlacement::~SavedPlacement()
+{
+}
+
+#endif
@@ -0,0 +1,56 @@
+#include "WireCellPgraph/AllocTracker.h"
+
+#include <new>
+
+using namespace WireCell::Pgraph;
+
+#ifdef __GLIBC__
+
+// Defined only by the preloaded libWireCellPgraphAlloc.  The weak
+// reference is null when it is not loaded.
+extern "C" void wirecell_pgraph_alloc_attach(AllocStats* stats) __attribute__((weak));
+
+bool AllocTracker::active()
+{
+    if (!wirecell_pgraph_alloc_attach) {
+        return false;
+    }
+    // Loaded, but only preloading puts its operators first.
+    AllocStats probe;
+    wirecell_pgraph_alloc_attach(&probe);
+    void* mem = ::operator new(1);
+    ::operator delete(mem);
+    wirecell_pgraph_alloc_attach(nullptr);
+    return probe.nallocs > 0;
+}
+
+void AllocTracker::attach(AllocStats* stats)
+{
+    if (wirecell_pgraph_alloc_attach) {
+        wirecell_pgraph_alloc_attach(stats);
+    }
+}
+
+void AllocTracker::detach()
+{
+    if (wirecell_pgraph_alloc_attach) {
+        wirecell_pgraph_alloc_attach(nullptr);
+    }
+}
+
+#else
+
+bool AllocTracker::active()
+{
+    return false;
+}
+
+void AllocTracker::attach(AllocStats* stats)
+{
+}
+
+void AllocTracker::detach()
+{
+}
+
+#endif
@@ -0,0 +1,39 @@
+#include "WireCellPgraph/Arena.h"
+
+#include <algorithm>
+#include <cstdint>
+
+using namespace WireCell::Pgraph;
+
+Arena::Arena(size_t chunk)
+    : m_chunk(std::max<size_t>(chunk, 64))
+    , m_bytes(0)
+    , m_next(nullptr)
+    , m_left(0)
+{
+}
+
+Arena::~Arena()
+{
+    for (auto it = m_made.rbegin(); it != m_made.rend(); ++it) {
+        it->destroy(it->obj);
+    }
+}
+
+void* Arena::allocate(size_t bytes, size_t align)
+{
+    size_t pad = (align - reinterpret_cast<uintptr_t>(m_next) % align) % align;
+    if (!m_next or pad + bytes > m_left) {
+        // Oversized requests get a chunk of their own.
+        size_t size = std::max(m_chunk, bytes + align);
+        m_chunks.emplace_back(new char[size]);
+        m_next = m_chunks.back().get();
+        m_left = size;
+        pad = (align - reinterpret_cast<uintptr_t>(m_next) % align) % align;
+    }
+    char* mem = m_next + pad;
+    m_next = mem + bytes;
+    m_left -= pad + bytes;
+    m_bytes += bytes;
+    return mem;
+}
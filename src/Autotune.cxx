@@ -0,0 +1,117 @@
+#include "WireCellPgraph/Autotune.h"
+#include "WireCellPgraph/Serializer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+using namespace WireCell;
+using namespace WireCell::Pgraph;
+
+WireCell::Configuration Pgraph::make_profile(Graph& graph, const NodeNames& names)
+{
+    Configuration ret;
+    ret["nodes"] = Json::arrayValue;
+    double total = 0;
+    const auto& stats = graph.node_stats();
+    for (auto node : graph.sort_kahn()) {
+        auto nit = names.find(node);
+        if (nit == names.end()) {
+            continue;
+        }
+        NodeStats st;
+        auto sit = stats.find(node);
+        if (sit != stats.end()) {
+            st = sit->second;
+        }
+        Configuration jnode;
+        jnode["node"] = nit->second;
+        jnode["calls"] = (Json::UInt64)st.calls;
+        jnode["fired"] = (Json::UInt64)st.fired;
+        jnode["seconds"] = st.seconds;
+        total += st.seconds;
+        ret["nodes"].append(jnode);
+    }
+    ret["seconds"] = total;
+    return ret;
+}
+
+WireCell::Configuration Pgraph::autotune(Graph& graph, const NodeNames& names,
+                                         const WireCell::Configuration& profile,
+                                         size_t nshards)
+{
+    std::unordered_map<std::string, double> busy;
+    for (auto jnode : profile["nodes"]) {
+        busy[jnode["node"].asString()] += jnode["seconds"].asDouble();
+    }
+
+    // Named nodes in topological order with their busy time.
+    std::vector<Node*> order;
+    std::vector<double> cost;
+    double total = 0, most = 0;
+    for (auto node : graph.sort_kahn()) {
+        auto nit = names.find(node);
+        if (nit == names.end()) {
+            continue;
+        }
+        double sec = busy[nit->second];
+        order.push_back(node);
+        cost.push_back(sec);
+        total += sec;
+        most = std::max(most, sec);
+    }
+
+    Configuration ret;
+    ret["weight"] = total;
+
+    // No more threads help than the costliest node allows.
+    size_t nthreads = std::max(1u, std::thread::hardware_concurrency());
+    if (most > 0) {
+        nthreads = std::min(nthreads, (size_t)std::ceil(total / most));
+    }
+    ret["threads"] = (int)nthreads;
+
+    if (nshards < 2 or order.size() < 2) {
+        return ret;
+    }
+
+    // A cut before position ind is allowed if each edge it crosses
+    // may be serialized.  Unnamed nodes sort with their neighbors.
+    std::unordered_map<Node*, size_t> pos;
+    for (size_t ind=0; ind<order.size(); ++ind) {
+        pos[order[ind]] = ind;
+    }
+    std::vector<bool> cuttable(order.size(), true);
+    cuttable[0] = false;
+    for (const auto& e : graph.edges()) {
+        auto tit = pos.find(e.tail), hit = pos.find(e.head);
+        if (tit == pos.end() or hit == pos.end()) {
+            continue;
+        }
+        if (Serializers::instance().find(e.tail->oport(e.tpind).signature())) {
+            continue;
+        }
+        for (size_t ind=tit->second+1; ind<=hit->second; ++ind) {
+            cuttable[ind] = false;
+        }
+    }
+
+    Configuration jshards = Json::arrayValue;
+    Configuration jshard = Json::arrayValue;
+    double sofar = 0;
+    size_t nmade = 0;
+    for (size_t ind=0; ind<order.size(); ++ind) {
+        double target = total * (nmade + 1) / nshards;
+        if (cuttable[ind] and nmade+1 < nshards and jshard.size()
+            and sofar + 0.5*cost[ind] > target) {
+            jshards.append(jshard);
+            jshard = Json::arrayValue;
+            ++nmade;
+        }
+        jshard.append(names.at(order[ind]));
+        sofar += cost[ind];
+    }
+    jshards.append(jshard);
+    ret["shards"] = jshards;
+    return ret;
+}
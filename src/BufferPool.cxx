@@ -0,0 +1,81 @@
+#include "WireCellPgraph/BufferPool.h"
+
+using namespace WireCell::Pgraph;
+
+BufferPool::BufferPool(size_t maxbytes)
+    : m_state(std::make_shared<State>())
+{
+    m_state->maxbytes = maxbytes;
+}
+
+size_t BufferPool::capacity(size_t bytes)
+{
+    size_t cap = 64;
+    while (cap < bytes) {
+        cap <<= 1;
+    }
+    return cap;
+}
+
+size_t BufferPool::filed(size_t bytes)
+{
+    size_t cap = 1;
+    while (cap <= bytes / 2) {
+        cap <<= 1;
+    }
+    return cap;
+}
+
+size_t BufferPool::hits() const
+{
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+    return m_state->hits;
+}
+
+size_t BufferPool::misses() const
+{
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+    return m_state->misses;
+}
+
+size_t BufferPool::held() const
+{
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+    return m_state->held;
+}
+
+BufferPool::State::~State()
+{
+    for (auto& it : free) {
+        for (auto& one : it.second) {
+            one.destroy(one.ptr);
+        }
+    }
+}
+
+void* BufferPool::State::take(const Key& key)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = free.find(key);
+    if (it == free.end() or it->second.empty()) {
+        ++misses;
+        return nullptr;
+    }
+    const Free& one = it->second.back();
+    void* ptr = one.ptr;
+    held -= one.bytes;
+    it->second.pop_back();
+    ++hits;
+    return ptr;
+}
+
+bool BufferPool::State::give(const Key& key, const Free& one)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (maxbytes and held + one.bytes > maxbytes) {
+        return false;
+    }
+    free[key].push_back(one);
+    held += one.bytes;
+    return true;
+}
@@ -0,0 +1,274 @@
+#include "WireCellPgraph/Cache.h"
+
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <utime.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+using namespace WireCell;
+using namespace WireCell::Pgraph;
+
+// SHA-256 as in FIPS 180-4.  A cache hit returns stored output
+// without running the node so keys must not collide in practice.
+static const uint32_t sha256_k[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+static inline uint32_t rotr(uint32_t x, int n)
+{
+    return (x >> n) | (x << (32 - n));
+}
+
+static void sha256_block(uint32_t* h, const unsigned char* block)
+{
+    uint32_t w[64];
+    for (int i=0; i<16; ++i) {
+        w[i] = (uint32_t(block[4*i]) << 24) | (uint32_t(block[4*i+1]) << 16)
+            | (uint32_t(block[4*i+2]) << 8) | uint32_t(block[4*i+3]);
+    }
+    for (int i=16; i<64; ++i) {
+        uint32_t s0 = rotr(w[i-15], 7) ^ rotr(w[i-15], 18) ^ (w[i-15] >> 3);
+        uint32_t s1 = rotr(w[i-2], 17) ^ rotr(w[i-2], 19) ^ (w[i-2] >> 10);
+        w[i] = w[i-16] + s0 + w[i-7] + s1;
+    }
+    uint32_t a=h[0], b=h[1], c=h[2], d=h[3], e=h[4], f=h[5], g=h[6], hh=h[7];
+    for (int i=0; i<64; ++i) {
+        uint32_t s1 = rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25);
+        uint32_t ch = (e & f) ^ (~e & g);
+        uint32_t t1 = hh + s1 + ch + sha256_k[i] + w[i];
+        uint32_t s0 = rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22);
+        uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+        uint32_t t2 = s0 + maj;
+        hh = g; g = f; f = e; e = d + t1;
+        d = c; c = b; b = a; a = t1 + t2;
+    }
+    h[0] += a; h[1] += b; h[2] += c; h[3] += d;
+    h[4] += e; h[5] += f; h[6] += g; h[7] += hh;
+}
+
+std::string Pgraph::cache_hash(const std::string& bytes)
+{
+    uint32_t h[8] = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+        0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+    };
+    const unsigned char* data = reinterpret_cast<const unsigned char*>(bytes.data());
+    const size_t size = bytes.size();
+    size_t full = size - size % 64;
+    for (size_t off=0; off<full; off += 64) {
+        sha256_block(h, data + off);
+    }
+
+    // Pad with a one bit, zeros and the length in bits.
+    unsigned char tail[128] = {0};
+    size_t rest = size - full;
+    std::copy(data + full, data + size, tail);
+    tail[rest] = 0x80;
+    size_t ntail = rest + 9 > 64 ? 128 : 64;
+    uint64_t nbits = uint64_t(size) * 8;
+    for (int i=0; i<8; ++i) {
+        tail[ntail-1-i] = (unsigned char)(nbits >> (8*i));
+    }
+    for (size_t off=0; off<ntail; off += 64) {
+        sha256_block(h, tail + off);
+    }
+
+    char buf[65];
+    for (int i=0; i<8; ++i) {
+        snprintf(buf + 8*i, 9, "%08x", h[i]);
+    }
+    return buf;
+}
+
+
+DiskCache::DiskCache(const std::string& dir, size_t maxbytes)
+    : m_dir(dir), m_max(maxbytes), m_total(0)
+    , m_hits(0), m_misses(0), m_evictions(0)
+{
+    if (mkdir(m_dir.c_str(), 0755) != 0 and errno != EEXIST) {
+        THROW(IOError() << errmsg{"failed to make cache directory: " + m_dir});
+    }
+
+    // Recover recency from a previous run by modification time.
+    DIR* dp = opendir(m_dir.c_str());
+    if (!dp) {
+        THROW(IOError() << errmsg{"failed to open cache directory: " + m_dir});
+    }
+    std::vector<std::pair<time_t, std::pair<std::string, size_t> > > found;
+    while (struct dirent* de = readdir(dp)) {
+        std::string key = de->d_name;
+        if (key.empty() or key[0] == '.') {
+            continue;
+        }
+        struct stat st;
+        if (stat(path(key).c_str(), &st) != 0 or !S_ISREG(st.st_mode)) {
+            continue;
+        }
+        found.push_back(std::make_pair(st.st_mtime, std::make_pair(key, (size_t)st.st_size)));
+    }
+    closedir(dp);
+    std::sort(found.begin(), found.end());
+    for (auto& one : found) {   // oldest first, each pushed to front
+        m_lru.push_front(one.second);
+        m_index[one.second.first] = m_lru.begin();
+        m_total += one.second.second;
+    }
+    evict();
+}
+
+std::string DiskCache::path(const std::string& key)
+{
+    return m_dir + "/" + key;
+}
+
+bool DiskCache::load(const std::string& key, std::string& bytes)
+{
+    auto it = m_index.find(key);
+    if (it == m_index.end()) {
+        ++m_misses;
+        return false;
+    }
+    std::ifstream fi(path(key), std::ios::binary);
+    if (!fi) {                  // removed behind our back
+        m_total -= it->second->second;
+        m_lru.erase(it->second);
+        m_index.erase(it);
+        ++m_misses;
+        return false;
+    }
+    std::stringstream ss;
+    ss << fi.rdbuf();
+    bytes = ss.str();
+
+    m_lru.splice(m_lru.begin(), m_lru, it->second);
+    utime(path(key).c_str(), nullptr);
+    ++m_hits;
+    return true;
+}
+
+void DiskCache::store(const std::string& key, const std::string& bytes)
+{
+    if (m_index.count(key)) {
+        return;
+    }
+    if (m_max and bytes.size() > m_max) {
+        return;                 // would only evict everything
+    }
+
+    // Write then rename so a crash never leaves a partial entry.
+    std::string tmp = path("." + key);
+    {
+        std::ofstream fo(tmp, std::ios::binary);
+        fo.write(bytes.data(), bytes.size());
+        if (!fo) {
+            THROW(IOError() << errmsg{"failed to write cache entry: " + tmp});
+        }
+    }
+    if (rename(tmp.c_str(), path(key).c_str()) != 0) {
+        THROW(IOError() << errmsg{"failed to store cache entry: " + key});
+    }
+
+    m_lru.push_front(std::make_pair(key, bytes.size()));
+    m_index[key] = m_lru.begin();
+    m_total += bytes.size();
+    evict();
+}
+
+void DiskCache::evict()
+{
+    if (!m_max) {
+        return;
+    }
+    while (m_total > m_max and !m_lru.empty()) {
+        auto& oldest = m_lru.back();
+        unlink(path(oldest.first).c_str());
+        m_total -= oldest.second;
+        m_index.erase(oldest.first);
+        m_lru.pop_back();
+        ++m_evictions;
+    }
+}
+
+
+CachedFunction::CachedFunction(INode::pointer wcnode,
+                               std::shared_ptr<DiskCache> cache,
+                               const std::string& nodekey)
+    : PortedNode(wcnode)
+    , m_wcnode(std::dynamic_pointer_cast<IFunctionNodeBase>(wcnode))
+    , m_cache(cache)
+    , m_nodehash(cache_hash(nodekey))
+    , m_iser(nullptr), m_oser(nullptr)
+    , m_hits(0), m_misses(0)
+{
+    if (!m_wcnode) {
+        THROW(ValueError() << errmsg{"Pgraph::CachedFunction given non-function node"});
+    }
+    m_iser = Serializers::instance().get(iport().signature());
+    m_oser = Serializers::instance().get(oport().signature());
+}
+
+bool CachedFunction::operator()()
+{
+    if (oport().size()) {
+        return false; // don't call me if I've got existing output waiting
+    }
+    if (iport().empty()) {
+        return false; // don't call me if there is nothing to give me.
+    }
+    return fire();
+}
+
+bool CachedFunction::fire()
+{
+    auto in = iport().get();
+    boost::any out;
+
+    if (m_iser->eos(in)) {
+        bool ok = (*m_wcnode)(in, out);
+        if (!ok) {
+            return false;
+        }
+        oport().put(out);
+        return true;
+    }
+
+    std::stringstream iss;
+    m_iser->write(iss, in);
+    std::string key = m_nodehash + cache_hash(iss.str());
+
+    std::string bytes;
+    if (m_cache->load(key, bytes)) {
+        ++m_hits;
+        std::stringstream oss(bytes);
+        out = m_oser->read(oss);
+        oport().put(out);
+        return true;
+    }
+
+    ++m_misses;
+    bool ok = (*m_wcnode)(in, out);
+    if (!ok) {
+        return false;
+    }
+    std::stringstream oss;
+    m_oser->write(oss, out);
+    m_cache->store(key, oss.str());
+    oport().put(out);
+    return true;
+}
@@ -0,0 +1,183 @@
+#include "WireCellPgraph/Executor.h"
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+
+using namespace WireCell;
+using namespace WireCell::Pgraph;
+
+Executor::Executor()
+    : m_nthreads(1)
+    , m_quantum(100)
+    , l(Log::logger("pgraph"))
+{
+}
+
+Executor& Executor::named(const std::string& name)
+{
+    static std::mutex mutex;
+    static std::map<std::string, std::unique_ptr<Executor> > executors;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& ex = executors[name];
+    if (!ex) {
+        ex.reset(new Executor);
+    }
+    return *ex;
+}
+
+void Executor::add(Graph* graph, const std::string& name,
+                   double weight, std::function<void()> setup,
+                   size_t quantum)
+{
+    if (weight <= 0) {
+        THROW(ValueError() << errmsg{"executor weight must be positive for " + name});
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& t : m_tenants) {
+        if (t->graph == graph) {
+            THROW(ValueError() << errmsg{"graph already added to executor: " + name});
+        }
+    }
+    auto t = new Tenant;
+    t->graph = graph;
+    t->name = name;
+    t->weight = weight;
+    t->setup = setup;
+    t->quantum = quantum;
+    m_tenants.emplace_back(t);
+}
+
+bool Executor::pending(Graph* graph)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& t : m_tenants) {
+        if (t->graph == graph) {
+            return t->pending;
+        }
+    }
+    return false;
+}
+
+void Executor::set_threads(size_t nthreads)
+{
+    if (!nthreads) {
+        nthreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    m_nthreads = std::max(m_nthreads, nthreads);
+}
+
+std::shared_ptr<ThreadPool> Executor::pool()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_pool) {
+        m_pool = std::make_shared<ThreadPool>(m_nthreads);
+    }
+    return m_pool;
+}
+
+WireCell::Configuration Executor::run()
+{
+    std::vector<Tenant*> active;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto& t : m_tenants) {
+            if (t->pending) {
+                t->pending = false;
+                active.push_back(t.get());
+            }
+        }
+    }
+    for (auto t : active) {
+        if (t->setup) {
+            t->setup();
+        }
+    }
+    l->debug("executor running {} graphs on {} workers",
+             active.size(), m_nthreads);
+
+    auto start = std::chrono::steady_clock::now();
+    size_t nworkers = std::min(active.size(), m_nthreads);
+    pool()->parallel_for(nworkers, [&](size_t) { work(active); });
+    std::chrono::duration<double> dt = std::chrono::steady_clock::now() - start;
+
+    Configuration ret;
+    ret["graphs"] = Json::arrayValue;
+    for (auto t : active) {
+        Configuration jt;
+        jt["name"] = t->name;
+        jt["weight"] = t->weight;
+        jt["quantum"] = (Json::UInt64)(t->quantum ? t->quantum : m_quantum);
+        jt["steps"] = (Json::UInt64)t->steps;
+        jt["calls"] = (Json::UInt64)t->calls;
+        jt["fired"] = (Json::UInt64)t->fired;
+        jt["seconds"] = t->seconds;
+        ret["graphs"].append(jt);
+    }
+    ret["seconds"] = dt.count();
+    return ret;
+}
+
+void Executor::work(std::vector<Tenant*>& active)
+{
+    while (true) {
+        Tenant* next = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            while (true) {
+                bool remaining = false;
+                for (auto t : active) {
+                    if (t->done) {
+                        continue;
+                    }
+                    remaining = true;
+                    if (t->running) {
+                        continue;
+                    }
+                    if (!next or t->pass < next->pass) {
+                        next = t;
+                    }
+                }
+                if (next or !remaining) {
+                    break;
+                }
+                // All remaining graphs are being stepped by others.
+                m_cv.wait(lock);
+            }
+            if (!next) {
+                return;
+            }
+            next->running = true;
+        }
+
+        Graph::StepStats ss;
+        try {
+            ss = next->graph->step(next->quantum ? next->quantum : m_quantum);
+            if (ss.done) {
+                next->graph->publish_metrics();
+            }
+        }
+        catch (...) {
+            // Let others finish rather than wait on this graph.
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                next->running = false;
+                next->done = true;
+            }
+            m_cv.notify_all();
+            throw;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            next->running = false;
+            next->done = ss.done;
+            ++next->steps;
+            next->calls += ss.calls;
+            next->fired += ss.fired;
+            next->seconds += ss.seconds;
+            next->pass += ss.seconds / next->weight;
+        }
+        m_cv.notify_all();
+    }
+}
@@ -0,0 +1,49 @@
+#include "WireCellPgraph/External.h"
+#include "WireCellUtil/Type.h"
+
+#include <sstream>
+
+using WireCell::demangle;
+using namespace WireCell::Pgraph;
+
+Ingress::Ingress(const std::string& name, const std::string& signature)
+    : m_name(name)
+{
+    m_ports[Port::output].push_back(Port(this, Port::output, signature, name));
+}
+
+std::string Ingress::ident()
+{
+    std::stringstream ss;
+    ss << "<Ingress name:" << m_name
+       << " sig:" << demangle(oport().signature()) << ">";
+    return ss.str();
+}
+
+void Ingress::push(Data data)
+{
+    oport().put(std::move(data));
+}
+
+Egress::Egress(const std::string& name, const std::string& signature)
+    : m_name(name)
+{
+    m_ports[Port::input].push_back(Port(this, Port::input, signature, name));
+}
+
+std::string Egress::ident()
+{
+    std::stringstream ss;
+    ss << "<Egress name:" << m_name
+       << " sig:" << demangle(iport().signature()) << ">";
+    return ss.str();
+}
+
+bool Egress::pull(Data& data)
+{
+    if (iport().empty()) {
+        return false;
+    }
+    data = iport().get();
+    return true;
+}
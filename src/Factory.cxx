@@ -1,10 +1,25 @@
 #include "WireCellPgraph/Factory.h"
+#include "WireCellPgraph/Graph.h"
 #include "WireCellPgraph/Wrappers.h"
 
 using namespace WireCell::Pgraph;
 
 Factory::Factory()
-    : l(Log::logger("pgraph"))
+    : m_own(new Arena)
+    , m_arena(*m_own)
+    , l(Log::logger("pgraph"))
+{
+    bind_makers();
+}
+
+Factory::Factory(Graph& graph)
+    : m_arena(graph.arena())
+    , l(Log::logger("pgraph"))
+{
+    bind_makers();
+}
+
+void Factory::bind_makers()
 {
     // categories defined in INode.h.
     // if it's not here, you ain't usin' it.
@@ -36,9 +51,9 @@ Node* Factory::operator()(WireCell::INode::pointer wcnode) {
                  wcnode->category());
         THROW(ValueError() << errmsg{"failed to find maker"});
     }
-    auto maker = mit->second;
-    
-    Node* node = (*maker)(wcnode);
+    auto& maker = *mit->second;
+
+    Node* node = maker(wcnode, m_arena);
     m_nodes[wcnode] = node;
     return node;
 }
@@ -1,6 +1,19 @@
 #include "WireCellPgraph/Graph.h"
+#include "WireCellPgraph/PerfCounters.h"
+#include "WireCellPgraph/Serializer.h"
+#include "WireCellPgraph/Cache.h"
 #include "WireCellUtil/Type.h"
 
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <sstream>
+#include <thread>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -8,8 +21,72 @@
 using WireCell::demangle;
 using namespace WireCell::Pgraph;
 
+namespace WireCell {
+    namespace Pgraph {
+        // Warn from a thread while a graph makes no progress.  It
+        // only reads atomics so it never disturbs execution.
+        class Watchdog {
+        public:
+            Watchdog(Graph& graph)
+                : m_graph(graph), m_done(false) {
+                if (m_graph.m_watchdog > 0) {
+                    m_thread = std::thread(&Watchdog::run, this);
+                }
+            }
+            ~Watchdog() {
+                if (!m_thread.joinable()) {
+                    return;
+                }
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_done = true;
+                }
+                m_cv.notify_all();
+                m_thread.join();
+            }
+        private:
+            void run() {
+                auto period = std::chrono::duration<double>(m_graph.m_watchdog);
+                size_t last = m_graph.m_progress;
+                std::unique_lock<std::mutex> lock(m_mutex);
+                while (!m_cv.wait_for(lock, period, [this]{return m_done;})) {
+                    size_t now = m_graph.m_progress;
+                    if (now != last) {
+                        last = now;
+                        continue;
+                    }
+                    Node* node = m_graph.m_current;
+                    m_graph.l->warn("watchdog: no progress in {} s after {} calls, in node: {}",
+                                    m_graph.m_watchdog, now,
+                                    node ? node->ident() : std::string("none"));
+                }
+            }
+            Graph& m_graph;
+            bool m_done;
+            std::mutex m_mutex;
+            std::condition_variable m_cv;
+            std::thread m_thread;
+        };
+    }
+}
+
 Graph::Graph()
-    : l(Log::logger("pgraph"))
+    : m_edge_arena(std::make_shared<Arena>())
+    , l(Log::logger("pgraph"))
+    , m_sorted_nedges(0)
+    , m_step_cursor(0)
+    , m_step_unfired(0)
+    , m_measuring(false)
+    , m_counting(false)
+    , m_tracking_allocs(false)
+    , m_timing_latency(false)
+    , m_recent_latency(0)
+    , m_checkpoint_interval(0)
+    , m_checkpoint_backoff(0)
+    , m_checkpoints(0)
+    , m_watchdog(0)
+    , m_progress(0)
+    , m_current(nullptr)
 {
 }
 
@@ -29,8 +106,8 @@ bool Graph::connect(Node* tail, Node* head, size_t tpind, size_t hpind)
         return false;
     }
 
-    m_edges.push_back(std::make_pair(tail,head));
-    Edge edge = std::make_shared<Queue>();
+    m_edges.push_back(EdgeEnds{tail, head, tpind, hpind});
+    Edge edge = std::allocate_shared<Queue>(ArenaAllocator<Queue>(m_edge_arena));
 
     tport.plug(edge);
     hport.plug(edge);                
@@ -52,13 +129,114 @@ bool Graph::connect(Node* tail, Node* head, size_t tpind, size_t hpind)
     return true;
 }
 
+void Graph::add_ingress(const std::string& name, Node* head, size_t hpind)
+{
+    if (m_ingress.count(name)) {
+        THROW(ValueError() << errmsg{"duplicate ingress: " + name});
+    }
+    auto node = m_arena.make<Ingress>(name, head->iport(hpind).signature());
+    m_ingress[name] = node;
+    connect(node, head, 0, hpind);
+}
+
+void Graph::add_egress(const std::string& name, Node* tail, size_t tpind)
+{
+    if (m_egress.count(name)) {
+        THROW(ValueError() << errmsg{"duplicate egress: " + name});
+    }
+    auto node = m_arena.make<Egress>(name, tail->oport(tpind).signature());
+    m_egress[name] = node;
+    connect(tail, node, tpind, 0);
+}
+
+Ingress* Graph::ingress(const std::string& name)
+{
+    auto it = m_ingress.find(name);
+    if (it == m_ingress.end()) {
+        THROW(KeyError() << errmsg{"no such ingress: " + name});
+    }
+    return it->second;
+}
+
+Egress* Graph::egress(const std::string& name)
+{
+    auto it = m_egress.find(name);
+    if (it == m_egress.end()) {
+        THROW(KeyError() << errmsg{"no such egress: " + name});
+    }
+    return it->second;
+}
+
+void Graph::push(const std::string& name, Data data)
+{
+    ingress(name)->push(std::move(data));
+}
+
+bool Graph::pull(const std::string& name, Data& data)
+{
+    return egress(name)->pull(data);
+}
+
+size_t Graph::waiting(const std::string& name)
+{
+    return egress(name)->size();
+}
+
+size_t Graph::prune(const std::vector<Node*>& targets)
+{
+    std::unordered_set<Node*> keep;
+    std::vector<Node*> todo;
+    for (Node* node : targets) {
+        if (!m_nodes.count(node)) {
+            THROW(ValueError() << errmsg{"target not in graph: " + node->ident()});
+        }
+        if (keep.insert(node).second) {
+            todo.push_back(node);
+        }
+    }
+    while (!todo.empty()) {
+        Node* node = todo.back();
+        todo.pop_back();
+        for (Node* parent : m_edges_backward[node]) {
+            if (keep.insert(parent).second) {
+                todo.push_back(parent);
+            }
+        }
+    }
+
+    std::vector<EdgeEnds> edges;
+    m_edges_forward.clear();
+    m_edges_backward.clear();
+    for (const auto& e : m_edges) {
+        if (!keep.count(e.tail)) {
+            continue;
+        }
+        if (!keep.count(e.head)) {
+            e.tail->oport(e.tpind).discard();
+            continue;
+        }
+        edges.push_back(e);
+        m_edges_forward[e.tail].push_back(e.head);
+        m_edges_backward[e.head].push_back(e.tail);
+    }
+
+    size_t nremoved = m_nodes.size() - keep.size();
+    l->debug("pruned {} of {} nodes and {} of {} edges",
+             nremoved, m_nodes.size(), m_edges.size() - edges.size(), m_edges.size());
+    m_nodes.swap(keep);
+    m_edges.swap(edges);
+    m_sorted.clear();
+    m_sorted_nedges = (size_t)-1;
+    return nremoved;
+}
+
 std::vector<Node*> Graph::sort_kahn() {
 
     std::unordered_map<Node*, int> nincoming;
-    for (auto th : m_edges) {
+    for (const auto& th : m_edges) {
 
-        nincoming[th.first] += 0; // make sure all nodes represented
-        nincoming[th.second] += 1;
+        nincoming[th.tail] += 0; // make sure all nodes represented
+        nincoming[th.head] += 1;
     }
                 
     std::vector<Node*> ret;
@@ -88,44 +266,425 @@ std::vector<Node*> Graph::sort_kahn() {
 int Graph::execute_upstream(Node* node)
 {
     int count = 0;
-    for (auto parent : m_edges_backward[node]) {
-        bool ok = call_node(parent);
-        if (ok) {
+    std::vector<Node*> demand{node};
+    std::unordered_set<Node*> asked{node};
+
+    while (!demand.empty()) {
+        Node* want = demand.back();
+        if (call_node(want)) {
             ++count;
+            demand.pop_back();
             continue;
         }
-        count += execute_upstream(parent);
+
+        // Not ready, ask parents not yet asked in this round.
+        bool asking = false;
+        for (auto parent : m_edges_backward[want]) {
+            if (asked.count(parent)) {
+                continue;
+            }
+            asked.insert(parent);
+            demand.push_back(parent);
+            asking = true;
+        }
+        if (!asking) {
+            // nothing more upstream can help this round
+            demand.pop_back();
+        }
     }
-    bool ok = call_node(node);
-    if (ok) { ++count; }
     return count;
 }
 
+std::vector<Node*> Graph::sinks()
+{
+    std::vector<Node*> ret;
+    for (auto node : sort_kahn()) {
+        if (m_edges_forward[node].empty()) {
+            ret.push_back(node);
+        }
+    }
+    return ret;
+}
+
+bool Graph::execute_pull()
+{
+    auto targets = sinks();
+    l->debug("executing pull with {} sinks", targets.size());
+    Watchdog watchdog(*this);
+
+    while (true) {
+        int count = 0;
+        for (auto sink : targets) {
+            count += execute_upstream(sink);
+        }
+        if (!count) {
+            publish_metrics();
+            return true;
+        }
+    }
+    return true;    // shouldn't reach
+}
+
+void Graph::prepare(ThreadPool& pool)
+{
+    std::vector<Node*> nodes(m_nodes.begin(), m_nodes.end());
+    l->debug("preparing {} nodes with {} threads", nodes.size(), pool.size());
+    auto t0 = std::chrono::steady_clock::now();
+    pool.parallel_for(nodes.size(), [&](size_t ind) {
+            nodes[ind]->prepare();
+        });
+    std::chrono::duration<double> dt = std::chrono::steady_clock::now() - t0;
+    l->debug("prepared in {:.3f} s", dt.count());
+}
+
+void Graph::set_context(const Context& ctx)
+{
+    for (auto node : m_nodes) {
+        node->set_context(ctx);
+    }
+}
+
 // this bool indicates exception, and is probably ignored
 bool Graph::execute()
 {
-    auto nodes = sort_kahn();
-    l->debug("executing with {} nodes", nodes.size());
+    l->debug("executing with {} nodes", sorted().size());
+    Watchdog watchdog(*this);
+    step();
+    publish_metrics();
+    return true;
+}
+
+const std::vector<Node*>& Graph::sorted()
+{
+    if (m_sorted_nedges != m_edges.size()) {
+        m_sorted = sort_kahn();
+        m_sorted_nedges = m_edges.size();
+    }
+    return m_sorted;
+}
+
+Graph::StepStats Graph::step(size_t max_calls,
+                             std::chrono::steady_clock::time_point deadline)
+{
+    const auto& nodes = sorted();
+    StepStats ss;
+    auto start = std::chrono::steady_clock::now();
+    auto forever = std::chrono::steady_clock::time_point::max();
 
     while (true) {
+        if (deadline != forever and std::chrono::steady_clock::now() >= deadline) {
+            break;
+        }
+        if (!m_checkpoint_file.empty()) {
+            std::chrono::duration<double> since = std::chrono::steady_clock::now() - m_checkpoint_last;
+            double wait = m_checkpoint_backoff > 0 ? m_checkpoint_backoff : m_checkpoint_interval;
+            if (since.count() >= wait) {
+                checkpoint();
+            }
+        }
 
-        int count = 0;
+        // Sweep up from the bottom of the graph, resuming where a
+        // limited call left off, until a node fires or every node
+        // has been called once without firing.
         bool did_something = false;            
+        bool limited = false;
+        while (m_step_unfired < nodes.size()) {
+            if (max_calls and ss.calls >= max_calls) {
+                limited = true;
+                break;
+            }
+            size_t count = m_step_cursor % nodes.size();
+            Node* node = nodes[nodes.size() - 1 - count];
 
-        for (auto nit = nodes.rbegin(); nit != nodes.rend(); ++nit, ++count) {
-            Node* node = *nit;
-
+            ++ss.calls;
             bool ok = call_node(node);
             if (ok) {
                 SPDLOG_LOGGER_TRACE(l, "ran node {}: {}", count, node->ident());
+                ++ss.fired;
                 did_something = true;
-                break;          // start again from bottom of graph
+                m_step_cursor = 0; // start again from bottom of graph
+                m_step_unfired = 0;
+                break;
             }
+            m_step_cursor = count + 1;
+            ++m_step_unfired;
+        }
+
+        if (limited) {
+            break;
+        }
+        if (!did_something) {
+            ss.done = true;     // it's okay to do nothing.
+            m_step_cursor = 0;
+            m_step_unfired = 0;
+            break;
+        }
+    }
+    ss.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return ss;
+}
+
+static size_t gcd(size_t a, size_t b)
+{
+    while (b) {
+        size_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+std::vector<StaticSchedule> Graph::static_schedules()
+{
+    auto sorted = sort_kahn();
+
+    // A node may be statically scheduled if it consumes and all its
+    // ports have fixed rates.  Sources are left dynamic as they may
+    // run dry at any time.
+    std::unordered_set<Node*> fixed;
+    for (auto node : sorted) {
+        if (node->input_ports().empty()) {
+            continue;
+        }
+        bool ok = true;
+        for (size_t ind=0; ind<node->input_ports().size(); ++ind) {
+            ok = ok and node->rate(Port::input, ind) > 0;
+        }
+        for (size_t ind=0; ind<node->output_ports().size(); ++ind) {
+            ok = ok and node->rate(Port::output, ind) > 0;
+        }
+        if (ok) {
+            fixed.insert(node);
+        }
+    }
+
+    // Group fixed nodes connected by edges, union-find style.
+    std::unordered_map<Node*, Node*> parent;
+    for (auto node : fixed) {
+        parent[node] = node;
+    }
+    auto find = [&](Node* n) {
+        while (parent[n] != n) {
+            parent[n] = parent[parent[n]];
+            n = parent[n];
+        }
+        return n;
+    };
+    for (const auto& e : m_edges) {
+        if (fixed.count(e.tail) and fixed.count(e.head)) {
+            parent[find(e.tail)] = find(e.head);
+        }
+    }
+    std::unordered_map<Node*, std::vector<Node*> > groups;
+    for (auto node : sorted) { // keep topological order in groups
+        if (fixed.count(node)) {
+            groups[find(node)].push_back(node);
+        }
+    }
 
+    std::vector<StaticSchedule> ret;
+    for (auto& git : groups) {
+        auto& members = git.second;
+        if (members.size() < 2) {
+            continue;
+        }
+        std::unordered_set<Node*> inside(members.begin(), members.end());
+
+        // Solve balance equations, tail_rate*q[tail] =
+        // head_rate*q[head], for the repetition vector as
+        // rationals.  Visiting in topological order means each
+        // node but the first is reached from a solved tail.
+        std::unordered_map<Node*, std::pair<size_t,size_t> > qrat;
+        qrat[members[0]] = std::make_pair(1,1);
+        bool consistent = true;
+        for (size_t iter=0; iter<members.size(); ++iter) {
+            for (const auto& e : m_edges) {
+                if (!inside.count(e.tail) or !inside.count(e.head)) {
+                    continue;
+                }
+                size_t prod = e.tail->rate(Port::output, e.tpind);
+                size_t cons = e.head->rate(Port::input, e.hpind);
+                bool have_t = qrat.count(e.tail), have_h = qrat.count(e.head);
+                if (have_t and have_h) {
+                    auto qt = qrat[e.tail], qh = qrat[e.head];
+                    if (qt.first*prod*qh.second != qh.first*cons*qt.second) {
+                        consistent = false;
+                    }
+                    continue;
+                }
+                if (have_t) {
+                    auto qt = qrat[e.tail];
+                    size_t num = qt.first*prod, den = qt.second*cons;
+                    size_t g = gcd(num, den);
+                    qrat[e.head] = std::make_pair(num/g, den/g);
+                }
+                else if (have_h) {
+                    auto qh = qrat[e.head];
+                    size_t num = qh.first*cons, den = qh.second*prod;
+                    size_t g = gcd(num, den);
+                    qrat[e.tail] = std::make_pair(num/g, den/g);
+                }
+            }
+        }
+        if (!consistent or qrat.size() != members.size()) {
+            l->warn("inconsistent rates in subgraph of {} nodes, scheduling dynamically",
+                    members.size());
+            continue;
+        }
+        size_t lcm = 1;
+        for (auto& q : qrat) {
+            lcm = lcm / gcd(lcm, q.second.second) * q.second.second;
+        }
+        std::unordered_map<Node*, size_t> remaining;
+        for (auto& q : qrat) {
+            remaining[q.first] = q.second.first * (lcm / q.second.second);
+        }
+
+        StaticSchedule sched;
+        sched.nodes = members;
+
+        // Edges into and within the subgraph.
+        std::vector<const EdgeEnds*> internal;
+        for (const auto& e : m_edges) {
+            if (!inside.count(e.head)) {
+                continue;
+            }
+            if (inside.count(e.tail)) {
+                internal.push_back(&e);
+                continue;
+            }
+            size_t need = remaining[e.head] * e.head->rate(Port::input, e.hpind);
+            sched.inputs.push_back(std::make_pair(&e.head->iport(e.hpind), need));
+        }
+
+        // Simulate a period to find an admissible firing order and
+        // the buffer bounds.
+        std::vector<size_t> tokens(internal.size(), 0);
+        sched.bounds.resize(internal.size(), 0);
+        bool progress = true;
+        while (progress) {
+            progress = false;
+            for (auto node : members) {
+                if (!remaining[node]) {
+                    continue;
+                }
+                bool ready = true;
+                for (size_t ind=0; ind<internal.size(); ++ind) {
+                    const auto& e = *internal[ind];
+                    if (e.head == node and tokens[ind] < node->rate(Port::input, e.hpind)) {
+                        ready = false;
+                    }
+                }
+                if (!ready) {
+                    continue;
+                }
+                for (size_t ind=0; ind<internal.size(); ++ind) {
+                    const auto& e = *internal[ind];
+                    if (e.head == node) {
+                        tokens[ind] -= node->rate(Port::input, e.hpind);
+                    }
+                    if (e.tail == node) {
+                        tokens[ind] += node->rate(Port::output, e.tpind);
+                        sched.bounds[ind] = std::max(sched.bounds[ind], tokens[ind]);
+                    }
+                }
+                sched.firings.push_back(node);
+                --remaining[node];
+                progress = true;
+            }
+        }
+        SPDLOG_LOGGER_TRACE(l, "static schedule: {} nodes, {} firings, {} inputs",
+                            sched.nodes.size(), sched.firings.size(), sched.inputs.size());
+        ret.push_back(sched);
+    }
+    return ret;
+}
+
+bool Graph::execute_sdf()
+{
+    auto scheds = static_schedules();
+    std::unordered_map<Node*, StaticSchedule*> member;
+    size_t nstatic = 0;
+    for (auto& sched : scheds) {
+        for (auto node : sched.nodes) {
+            member[node] = &sched;
+        }
+        nstatic += sched.nodes.size();
+    }
+    auto nodes = sort_kahn();
+    l->debug("executing with {} nodes, {} in {} static schedules",
+             nodes.size(), nstatic, scheds.size());
+    Watchdog watchdog(*this);
+
+    // Each unit is either a dynamic node or, at the place of its
+    // bottom-most member, a whole static schedule.  A schedule
+    // which breaks is dissolved back to dynamic nodes.
+    std::unordered_set<StaticSchedule*> dissolved;
+    std::vector<std::pair<Node*, StaticSchedule*> > units;
+    auto make_units = [&]() {
+        units.clear();
+        std::unordered_set<StaticSchedule*> placed;
+        for (auto nit = nodes.rbegin(); nit != nodes.rend(); ++nit) {
+            auto sit = member.find(*nit);
+            if (sit == member.end() or dissolved.count(sit->second)) {
+                units.push_back(std::make_pair(*nit, nullptr));
+                continue;
+            }
+            if (placed.count(sit->second)) {
+                continue;
+            }
+            placed.insert(sit->second);
+            units.push_back(std::make_pair(nullptr, sit->second));
+        }
+    };
+    make_units();
+    size_t placed_dissolved = 0;
+
+    while (true) {
+        bool did_something = false;
+        for (auto& unit : units) {
+            if (unit.first) {
+                if (call_node(unit.first)) {
+                    did_something = true;
+                    break;
+                }
+                continue;
+            }
+
+            StaticSchedule* sched = unit.second;
+            bool ready = true;
+            for (auto& need : sched->inputs) {
+                if (need.first->size() < need.second) {
+                    ready = false;
+                    break;
+                }
+            }
+            if (!ready) {
+                continue;
+            }
+            for (auto node : sched->firings) {
+                begin_call(node);
+                bool ok = node->fire();
+                end_call(node, ok);
+                if (!ok) {
+                    // Any partial period is left on the edges for
+                    // the members to finish dynamically.
+                    l->warn("static schedule broken by node: {}", node->ident());
+                    dissolved.insert(sched);
+                    break;
+                }
+            }
+            did_something = true;
+            break;
+        }
+        if (dissolved.size() != placed_dissolved) {
+            placed_dissolved = dissolved.size();
+            make_units();
         }
 
         if (!did_something) {
-            return true;        // it's okay to do nothing.
+            publish_metrics();
+            return true;
         }
     }
     return true;    // shouldn't reach
@@ -137,7 +696,9 @@ bool Graph::call_node(Node* node)
         l->error("graph call: got nullptr node");
         return false;
     }
+    begin_call(node);
     bool ok = (*node)();
+    end_call(node, ok);
     // this can be very noisy but useful to uncomment to understand
     // the graph execution order.
     if (ok) {
@@ -146,6 +707,143 @@ bool Graph::call_node(Node* node)
     return ok;
 }
 
+void Graph::begin_call(Node* node)
+{
+    node->reset_origin();
+    if (m_watchdog > 0) {
+        m_current = node;
+    }
+    if (!m_measuring) {
+        return;
+    }
+    if (m_counting) {
+        PerfCounters::thread_counters().read(m_call_counters);
+    }
+    if (m_tracking_allocs) {
+        AllocTracker::attach(&m_stats[node].alloc);
+    }
+    m_call_start = std::chrono::steady_clock::now();
+}
+
+void Graph::end_call(Node* node, bool ok)
+{
+    if (m_watchdog > 0) {
+        m_current = nullptr;
+        if (ok) {
+            ++m_progress;
+        }
+    }
+
+    if (ok and m_timing_latency and node->output_ports().empty()) {
+        Stamp stamp;
+        if (node->unsent(stamp)) {
+            std::chrono::duration<double> dt = std::chrono::steady_clock::now() - stamp;
+            m_latency[node].fill(dt.count());
+            m_recent_latency = dt.count();
+            node->sent(stamp); // a sink is done with what it consumed
+        }
+    }
+
+    if (!m_measuring) {
+        return;
+    }
+    auto now = std::chrono::steady_clock::now();
+    if (m_tracking_allocs) {
+        AllocTracker::detach();
+    }
+
+    auto& st = m_stats[node];
+    ++st.calls;
+    st.seconds += std::chrono::duration<double>(now - m_call_start).count();
+    if (m_counting) {
+        PerfCounters::thread_counters().read(m_counter_now);
+        st.counters.resize(m_counter_now.size(), 0);
+        for (size_t ind=0; ind<m_counter_now.size(); ++ind) {
+            st.counters[ind] += m_counter_now[ind] - m_call_counters[ind];
+        }
+    }
+    if (ok) {
+        ++st.fired;
+    }
+
+    if (m_metrics) {
+        update_gauges(node, st);
+    }
+}
+
+bool Graph::enable_alloc_tracking()
+{
+    m_tracking_allocs = AllocTracker::active();
+    m_measuring = m_measuring or m_tracking_allocs;
+    return m_tracking_allocs;
+}
+
+const std::vector<std::string>& Graph::counter_names()
+{
+    return PerfCounters::thread_counters().names();
+}
+
+WireCell::Configuration Graph::statistics()
+{
+    Configuration ret;
+    ret["nodes"] = Json::arrayValue;
+    ret["latency"] = Json::arrayValue;
+
+    const auto& names = counter_names();
+    for (auto node : sort_kahn()) {
+        const auto& st = m_stats[node];
+        Configuration jnode;
+        jnode["node"] = node->ident();
+        jnode["calls"] = (Json::UInt64)st.calls;
+        jnode["fired"] = (Json::UInt64)st.fired;
+        jnode["seconds"] = st.seconds;
+        if (!st.counters.empty()) {
+            for (size_t ind=0; ind<names.size() and ind<st.counters.size(); ++ind) {
+                jnode["counters"][names[ind]] = (Json::UInt64)st.counters[ind];
+            }
+        }
+        if (m_tracking_allocs) {
+            const auto& as = st.alloc;
+            jnode["alloc"]["nallocs"] = (Json::UInt64)as.nallocs;
+            jnode["alloc"]["nfrees"] = (Json::UInt64)as.nfrees;
+            jnode["alloc"]["alloc_bytes"] = (Json::UInt64)as.alloc_bytes;
+            jnode["alloc"]["free_bytes"] = (Json::UInt64)as.free_bytes;
+            jnode["alloc"]["peak_bytes"] = (Json::Int64)as.peak_bytes;
+        }
+        ret["nodes"].append(jnode);
+    }
+    for (const auto& it : m_latency) {
+        const auto& lh = it.second;
+        Configuration jlat;
+        jlat["node"] = it.first->ident();
+        jlat["count"] = (Json::UInt64)lh.count();
+        jlat["p50"] = lh.quantile(0.5);
+        jlat["p99"] = lh.quantile(0.99);
+        jlat["max"] = lh.max();
+        ret["latency"].append(jlat);
+    }
+    return ret;
+}
+
+void Graph::enable_latency()
+{
+    for (const auto& e : m_edges) {
+        auto stamps = std::make_shared<std::deque<Stamp> >();
+        e.tail->oport(e.tpind).plug_stamps(stamps);
+        e.head->iport(e.hpind).plug_stamps(stamps);
+    }
+    m_timing_latency = true;
+}
+
+size_t Graph::max_depth()
+{
+    size_t ret = 0;
+    for (const auto& e : m_edges) {
+        ret = std::max(ret, e.tail->oport(e.tpind).size());
+    }
+    return ret;
+}
+
 bool Graph::connected()
 {
     for (auto n : m_nodes) {
@@ -156,3 +854,466 @@ bool Graph::connected()
     return true;
 }
 
+
+WireCell::Configuration Graph::diagnose()
+{
+    Configuration ret;
+    ret["stalled"] = false;
+    ret["edges"] = Json::arrayValue;
+    ret["waiting"] = Json::arrayValue;
+    ret["cycles"] = Json::arrayValue;
+
+    for (const auto& e : m_edges) {
+        size_t depth = e.head->iport(e.hpind).size();
+        if (!depth) {
+            continue;
+        }
+        Configuration jedge;
+        jedge["tail"] = e.tail->ident();
+        jedge["tport"] = (int)e.tpind;
+        jedge["head"] = e.head->ident();
+        jedge["hport"] = (int)e.hpind;
+        jedge["depth"] = (int)depth;
+        ret["edges"].append(jedge);
+        ret["stalled"] = true;
+    }
+
+    // A node waits on the tails of its empty input edges and on the
+    // heads of its output edges still holding data.  Only those
+    // holding input or output are reported as waiting.
+    std::unordered_map<Node*, std::vector<Node*> > waits_on;
+    for (auto node : sort_kahn()) {
+        Configuration jnode;
+        jnode["node"] = node->ident();
+        jnode["empty"] = Json::arrayValue;
+        jnode["blocked"] = Json::arrayValue;
+        bool holding = false;
+        auto& waits = waits_on[node];
+        for (const auto& e : m_edges) {
+            if (e.head == node) {
+                if (e.head->iport(e.hpind).empty()) {
+                    jnode["empty"].append((int)e.hpind);
+                    waits.push_back(e.tail);
+                }
+                else {
+                    holding = true;
+                }
+            }
+            if (e.tail == node and !e.head->iport(e.hpind).empty()) {
+                jnode["blocked"].append((int)e.tpind);
+                waits.push_back(e.head);
+                holding = true;
+            }
+        }
+        if (holding) {
+            ret["waiting"].append(jnode);
+        }
+    }
+
+    // Cycles are the strongly connected components of more than one
+    // node in the wait-for graph.  Tarjan's algorithm, iteratively.
+    std::unordered_map<Node*, int> index, low;
+    std::unordered_set<Node*> onstack;
+    std::vector<Node*> stack;
+    int counter = 0;
+    for (auto& root : waits_on) {
+        if (index.count(root.first)) {
+            continue;
+        }
+        std::vector<std::pair<Node*, size_t> > work{{root.first, 0}};
+        while (!work.empty()) {
+            Node* v = work.back().first;
+            size_t& next = work.back().second;
+            if (next == 0) {
+                index[v] = low[v] = counter++;
+                stack.push_back(v);
+                onstack.insert(v);
+            }
+            auto wit = waits_on.find(v);
+            size_t nsucc = wit == waits_on.end() ? 0 : wit->second.size();
+            if (next < nsucc) {
+                const auto& succ = wit->second;
+                Node* w = succ[next++];
+                if (!index.count(w)) {
+                    work.push_back(std::make_pair(w, 0));
+                }
+                else if (onstack.count(w)) {
+                    low[v] = std::min(low[v], index[w]);
+                }
+                continue;
+            }
+            if (low[v] == index[v]) {
+                Configuration jcycle = Json::arrayValue;
+                Node* w = nullptr;
+                do {
+                    w = stack.back();
+                    stack.pop_back();
+                    onstack.erase(w);
+                    jcycle.append(w->ident());
+                } while (w != v);
+                if (jcycle.size() > 1) {
+                    ret["cycles"].append(jcycle);
+                }
+            }
+            work.pop_back();
+            if (!work.empty()) {
+                Node* u = work.back().first;
+                low[u] = std::min(low[u], low[v]);
+            }
+        }
+    }
+    return ret;
+}
+
+void Graph::set_metrics(const std::string& filename, double interval,
+                        const std::string& format)
+{
+    m_metrics.reset(new MetricsWriter(filename, interval, format));
+    m_measuring = true;
+    m_gauges.reset();
+    m_node_gauges.clear();
+}
+
+void Graph::update_gauges(Node* node, const NodeStats& st)
+{
+    if (!m_gauges) {
+        // The graph is complete once it runs so name what the
+        // writer will read and set it going.
+        m_gauges = std::make_shared<MetricsGauges>();
+        std::unordered_map<Node*, std::string> labels;
+        std::unordered_map<std::string, size_t> taken;
+        for (auto one : sorted()) {
+            auto it = m_names.find(one);
+            std::string label = it == m_names.end() ? one->ident() : it->second;
+            size_t count = taken[label]++;
+            if (count) {
+                label += "#" + std::to_string(count);
+            }
+            labels[one] = label;
+            m_gauges->nodes.emplace_back();
+            m_gauges->nodes.back().name = label;
+            m_node_gauges[one].node = &m_gauges->nodes.back();
+        }
+        for (const auto& e : m_edges) {
+            m_gauges->edges.emplace_back();
+            auto& eg = m_gauges->edges.back();
+            eg.tail = labels[e.tail];
+            eg.tport = (int)e.tpind;
+            eg.head = labels[e.head];
+            eg.hport = (int)e.hpind;
+            Port* port = &e.head->iport(e.hpind);
+            m_node_gauges[e.tail].edges.emplace_back(port, &eg);
+            m_node_gauges[e.head].edges.emplace_back(port, &eg);
+        }
+        m_metrics->start(m_gauges);
+    }
+
+    // A call may change only the depths of the node's own edges.
+    auto& ng = m_node_gauges[node];
+    ng.node->calls.store(st.calls, std::memory_order_relaxed);
+    ng.node->fired.store(st.fired, std::memory_order_relaxed);
+    ng.node->seconds.store(st.seconds, std::memory_order_relaxed);
+    for (auto& pe : ng.edges) {
+        pe.second->depth.store(pe.first->size(), std::memory_order_relaxed);
+    }
+}
+
+void Graph::publish_metrics()
+{
+    if (m_metrics and m_metrics->started()) {
+        m_metrics->flush();
+    }
+}
+
+static std::string dot_escape(const std::string& str)
+{
+    std::string ret;
+    for (char c : str) {
+        if (c == '"' or c == '\\') {
+            ret += '\\';
+        }
+        ret += c;
+    }
+    return ret;
+}
+
+void Graph::write_dot(std::ostream& os)
+{
+    const auto& nodes = sorted();
+    std::unordered_map<Node*, size_t> index;
+    double total = 0;
+    for (size_t ind=0; ind<nodes.size(); ++ind) {
+        index[nodes[ind]] = ind;
+        auto sit = m_stats.find(nodes[ind]);
+        if (sit != m_stats.end()) {
+            total += sit->second.seconds;
+        }
+    }
+    const bool measured = !m_stats.empty();
+
+    // Path of most busy time, found in topological order.
+    std::unordered_set<Node*> hot;
+    std::unordered_set<const EdgeEnds*> hot_edges;
+    if (measured) {
+        std::vector<double> best(nodes.size(), 0);
+        std::vector<const EdgeEnds*> via(nodes.size(), nullptr);
+        std::unordered_map<Node*, std::vector<const EdgeEnds*> > incoming;
+        for (const auto& e : m_edges) {
+            incoming[e.head].push_back(&e);
+        }
+        // The path must end at a sink, even one with no busy time.
+        size_t last = nodes.size();
+        for (size_t ind=0; ind<nodes.size(); ++ind) {
+            for (auto e : incoming[nodes[ind]]) {
+                size_t tind = index[e->tail];
+                if (!via[ind] or best[tind] > best[index[via[ind]->tail]]) {
+                    via[ind] = e;
+                }
+            }
+            best[ind] = m_stats[nodes[ind]].seconds;
+            if (via[ind]) {
+                best[ind] += best[index[via[ind]->tail]];
+            }
+            if (m_edges_forward[nodes[ind]].empty()
+                and (last == nodes.size() or best[ind] > best[last])) {
+                last = ind;
+            }
+        }
+        if (last < nodes.size()) {
+            hot.insert(nodes[last]);
+            for (auto e = via[last]; e; e = via[index[e->tail]]) {
+                hot_edges.insert(e);
+                hot.insert(e->tail);
+            }
+        }
+    }
+
+    os << "digraph pgraph {\n"
+       << "  node [shape=box];\n";
+    for (size_t ind=0; ind<nodes.size(); ++ind) {
+        Node* node = nodes[ind];
+        std::stringstream label;
+        label << dot_escape(node->ident());
+        if (measured) {
+            const auto& st = m_stats[node];
+            label << "\\ncalls: " << st.calls << " fired: " << st.fired
+                  << "\\nbusy: " << st.seconds << " s";
+            if (total > 0) {
+                label << " (" << (int)(100*st.seconds/total) << "%)";
+            }
+        }
+        os << "  n" << ind << " [label=\"" << label.str() << "\"";
+        if (hot.count(node)) {
+            os << ", color=red, penwidth=2";
+        }
+        os << "];\n";
+    }
+    for (const auto& e : m_edges) {
+        Port& tport = e.tail->oport(e.tpind);
+        os << "  n" << index[e.tail] << " -> n" << index[e.head]
+           << " [label=\"" << dot_escape(demangle(tport.signature()));
+        if (measured) {
+            os << "\\npeak: " << tport.peak();
+        }
+        os << "\"";
+        if (hot_edges.count(&e)) {
+            os << ", color=red, penwidth=2";
+        }
+        os << "];\n";
+    }
+    os << "}\n";
+}
+
+
+static const char* checkpoint_magic = "WCPGCKPT";
+
+static void put_u64(std::ostream& so, uint64_t val)
+{
+    so.write(reinterpret_cast<const char*>(&val), sizeof(val));
+}
+static void put_string(std::ostream& so, const std::string& str)
+{
+    put_u64(so, str.size());
+    so.write(str.data(), str.size());
+}
+static uint64_t take_u64(std::istream& si)
+{
+    uint64_t val = 0;
+    si.read(reinterpret_cast<char*>(&val), sizeof(val));
+    if (!si) {
+        THROW(WireCell::IOError() << WireCell::errmsg{"premature end of checkpoint"});
+    }
+    return val;
+}
+static std::string take_string(std::istream& si)
+{
+    std::string str(take_u64(si), 0);
+    si.read(&str[0], str.size());
+    if (!si) {
+        THROW(WireCell::IOError() << WireCell::errmsg{"premature end of checkpoint"});
+    }
+    return str;
+}
+
+// Nodes in order of first appearance on an edge, which is the same
+// from run to run of the same configuration.
+static std::vector<Node*> edge_order(const std::vector<Graph::EdgeEnds>& edges)
+{
+    std::vector<Node*> ret;
+    std::unordered_set<Node*> seen;
+    for (const auto& e : edges) {
+        for (Node* node : {e.tail, e.head}) {
+            if (seen.insert(node).second) {
+                ret.push_back(node);
+            }
+        }
+    }
+    return ret;
+}
+
+std::string Graph::fingerprint()
+{
+    // Nodes of the same type differ only by their configured names.
+    auto label = [this](Node* node) {
+        std::string ret = node->ident();
+        auto it = m_names.find(node);
+        if (it != m_names.end()) {
+            ret += " " + it->second;
+        }
+        return ret;
+    };
+    std::stringstream ss;
+    for (const auto& e : m_edges) {
+        ss << label(e.tail) << ":" << e.tpind << " -> "
+           << label(e.head) << ":" << e.hpind << "\n";
+    }
+    return cache_hash(ss.str());
+}
+
+bool Graph::save_checkpoint(std::ostream& so)
+{
+    // Check all can be saved before saving any.
+    std::vector<Serializer*> sers(m_edges.size(), nullptr);
+    for (size_t ind=0; ind<m_edges.size(); ++ind) {
+        Port& tport = m_edges[ind].tail->oport(m_edges[ind].tpind);
+        if (tport.edge()->empty()) {
+            continue;
+        }
+        sers[ind] = Serializers::instance().find(tport.signature());
+        if (!sers[ind]) {
+            l->debug("checkpoint waits on edge without serializer: {}",
+                     demangle(tport.signature()));
+            return false;
+        }
+    }
+
+    // Node states next as a node midway through work is the likely
+    // reason to wait.
+    auto nodes = edge_order(m_edges);
+    std::vector<std::string> states(nodes.size());
+    for (size_t ind=0; ind<nodes.size(); ++ind) {
+        if (!nodes[ind]->save_state(states[ind])) {
+            l->debug("checkpoint waits on node: {}", nodes[ind]->ident());
+            return false;
+        }
+    }
+
+    // Gather all so nothing is written if not safe.
+    std::stringstream ss;
+    ss.write(checkpoint_magic, 8);
+    put_string(ss, fingerprint());
+
+    put_u64(ss, m_edges.size());
+    for (size_t ind=0; ind<m_edges.size(); ++ind) {
+        auto edge = m_edges[ind].tail->oport(m_edges[ind].tpind).edge();
+        put_u64(ss, edge->size());
+        for (const auto& data : *edge) {
+            sers[ind]->write(ss, data);
+        }
+    }
+
+    put_u64(ss, nodes.size());
+    for (const auto& state : states) {
+        put_string(ss, state);
+    }
+
+    so << ss.rdbuf();
+    return true;
+}
+
+void Graph::load_checkpoint(std::istream& si)
+{
+    std::string magic(8, 0);
+    si.read(&magic[0], 8);
+    if (!si or magic != checkpoint_magic) {
+        THROW(IOError() << errmsg{"not a pgraph checkpoint"});
+    }
+    if (take_string(si) != fingerprint()) {
+        THROW(ValueError() << errmsg{"checkpoint is of a different graph"});
+    }
+
+    if (take_u64(si) != m_edges.size()) {
+        THROW(ValueError() << errmsg{"checkpoint has wrong number of edges"});
+    }
+    size_t ndata = 0;
+    for (const auto& e : m_edges) {
+        Port& tport = e.tail->oport(e.tpind);
+        size_t num = take_u64(si);
+        if (!num) {
+            continue;
+        }
+        auto ser = Serializers::instance().get(tport.signature());
+        for (size_t ind=0; ind<num; ++ind) {
+            Data data = ser->read(si);
+            tport.put(data);
+        }
+        ndata += num;
+    }
+
+    auto nodes = edge_order(m_edges);
+    if (take_u64(si) != nodes.size()) {
+        THROW(ValueError() << errmsg{"checkpoint has wrong number of nodes"});
+    }
+    for (Node* node : nodes) {
+        node->load_state(take_string(si));
+    }
+    l->debug("loaded checkpoint with {} data on {} edges and {} nodes",
+             ndata, m_edges.size(), nodes.size());
+}
+
+void Graph::set_checkpoint(const std::string& filename, double interval)
+{
+    m_checkpoint_file = filename;
+    m_checkpoint_interval = interval;
+    m_checkpoint_backoff = 0;
+    m_checkpoint_last = std::chrono::steady_clock::now();
+}
+
+bool Graph::checkpoint()
+{
+    std::string tmp = m_checkpoint_file + ".tmp";
+    {
+        std::ofstream fo(tmp, std::ios::binary);
+        if (!save_checkpoint(fo)) {
+            fo.close();
+            std::remove(tmp.c_str());
+            // Try again soon, then less often, rather than on
+            // every call while the graph is not safe to save.
+            m_checkpoint_last = std::chrono::steady_clock::now();
+            m_checkpoint_backoff = m_checkpoint_backoff > 0
+                ? std::min(2*m_checkpoint_backoff, m_checkpoint_interval)
+                : m_checkpoint_interval / 16;
+            return false;
+        }
+        if (!fo) {
+            THROW(IOError() << errmsg{"failed to write checkpoint: " + tmp});
+        }
+    }
+    if (std::rename(tmp.c_str(), m_checkpoint_file.c_str()) != 0) {
+        THROW(IOError() << errmsg{"failed to replace checkpoint: " + m_checkpoint_file});
+    }
+    m_checkpoint_last = std::chrono::steady_clock::now();
+    m_checkpoint_backoff = 0;
+    ++m_checkpoints;
+    return true;
+}
@@ -0,0 +1,54 @@
+#include "WireCellPgraph/Latency.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace WireCell::Pgraph;
+
+static const double lowest = 1e-6; // seconds
+static const int per_decade = 20;
+static const int ndecades = 10;
+
+LatencyHistogram::LatencyHistogram()
+    : m_bins(per_decade*ndecades, 0)
+    , m_count(0), m_sum(0), m_max(0)
+{
+}
+
+void LatencyHistogram::fill(double seconds)
+{
+    int ind = 0;
+    if (seconds > lowest) {
+        ind = (int)(per_decade*std::log10(seconds/lowest));
+        ind = std::min(ind, (int)m_bins.size()-1);
+    }
+    ++m_bins[ind];
+    ++m_count;
+    m_sum += seconds;
+    m_max = std::max(m_max, seconds);
+}
+
+double LatencyHistogram::mean() const
+{
+    if (!m_count) {
+        return 0;
+    }
+    return m_sum/m_count;
+}
+
+double LatencyHistogram::quantile(double frac) const
+{
+    if (!m_count) {
+        return 0;
+    }
+    size_t want = std::ceil(frac*m_count);
+    size_t have = 0;
+    for (size_t ind=0; ind<m_bins.size(); ++ind) {
+        have += m_bins[ind];
+        if (have >= want) {
+            double upper = lowest * std::pow(10.0, double(ind+1)/per_decade);
+            return std::min(upper, m_max);
+        }
+    }
+    return m_max;
+}
@@ -0,0 +1,187 @@
+#include "WireCellPgraph/Metrics.h"
+#include "WireCellUtil/Exceptions.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+using namespace WireCell;
+using namespace WireCell::Pgraph;
+
+MetricsWriter::MetricsWriter(const std::string& filename, double interval,
+                             const std::string& format)
+    : m_filename(filename)
+    , m_format(format)
+    , m_interval(interval)
+    , m_flush(false)
+    , m_done(false)
+    , l(Log::logger("pgraph"))
+{
+    if (m_format != "json" and m_format != "prometheus") {
+        THROW(ValueError() << errmsg{"unknown metrics format: " + m_format});
+    }
+}
+
+MetricsWriter::~MetricsWriter()
+{
+    if (!m_thread.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_done = true;
+    }
+    m_cv.notify_all();
+    m_thread.join();
+}
+
+void MetricsWriter::start(std::shared_ptr<const MetricsGauges> gauges)
+{
+    m_gauges = gauges;
+    m_start = m_last = std::chrono::steady_clock::now();
+    m_prev.assign(m_gauges->nodes.size(), Previous());
+    m_thread = std::thread(&MetricsWriter::run, this);
+}
+
+void MetricsWriter::flush()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_flush = true;
+    }
+    m_cv.notify_all();
+}
+
+void MetricsWriter::run()
+{
+    auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(m_interval));
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        auto wake = [this]{ return m_flush or m_done; };
+        if (m_interval > 0) {
+            m_cv.wait_until(lock, m_last + period, wake);
+        }
+        else {
+            m_cv.wait(lock, wake);
+        }
+        bool done = m_done;
+        m_flush = false;
+        lock.unlock();
+        write(snapshot());
+        lock.lock();
+        if (done) {
+            return;
+        }
+    }
+}
+
+WireCell::Configuration MetricsWriter::snapshot()
+{
+    auto now = std::chrono::steady_clock::now();
+    double dt = std::chrono::duration<double>(now - m_last).count();
+    m_last = now;
+
+    Configuration snap;
+    snap["elapsed"] = std::chrono::duration<double>(now - m_start).count();
+    snap["nodes"] = Json::arrayValue;
+    snap["edges"] = Json::arrayValue;
+    size_t ind = 0;
+    for (const auto& g : m_gauges->nodes) {
+        auto& prev = m_prev[ind++];
+        uint64_t fired = g.fired.load(std::memory_order_relaxed);
+        double seconds = g.seconds.load(std::memory_order_relaxed);
+        Configuration jnode;
+        jnode["node"] = g.name;
+        jnode["calls"] = (Json::UInt64)g.calls.load(std::memory_order_relaxed);
+        jnode["fired"] = (Json::UInt64)fired;
+        jnode["seconds"] = seconds;
+        jnode["rate"] = dt > 0 ? (fired - prev.fired) / dt : 0.0;
+        jnode["busy"] = dt > 0 ? (seconds - prev.seconds) / dt : 0.0;
+        prev.fired = fired;
+        prev.seconds = seconds;
+        snap["nodes"].append(jnode);
+    }
+    for (const auto& g : m_gauges->edges) {
+        Configuration jedge;
+        jedge["tail"] = g.tail;
+        jedge["tport"] = g.tport;
+        jedge["head"] = g.head;
+        jedge["hport"] = g.hport;
+        jedge["depth"] = (Json::UInt64)g.depth.load(std::memory_order_relaxed);
+        snap["edges"].append(jedge);
+    }
+    return snap;
+}
+
+void MetricsWriter::write(const WireCell::Configuration& snapshot)
+{
+    std::string tmp = m_filename + ".tmp";
+    {
+        std::ofstream fo(tmp);
+        if (m_format == "prometheus") {
+            fo << prometheus(snapshot);
+        }
+        else {
+            fo << snapshot << std::endl;
+        }
+        if (!fo) {
+            l->warn("failed to write metrics to {}", tmp);
+            return;
+        }
+    }
+    if (rename(tmp.c_str(), m_filename.c_str()) != 0) {
+        l->warn("failed to rename metrics to {}", m_filename);
+    }
+}
+
+static std::string label(const std::string& val)
+{
+    std::string ret;
+    for (char c : val) {
+        if (c == '\\' or c == '"') {
+            ret += '\\';
+            ret += c;
+        }
+        else if (c == '\n') {
+            ret += "\\n";
+        }
+        else {
+            ret += c;
+        }
+    }
+    return ret;
+}
+
+std::string MetricsWriter::prometheus(const WireCell::Configuration& snapshot)
+{
+    std::stringstream ss;
+    ss << "# TYPE pgraph_elapsed_seconds gauge\n"
+       << "pgraph_elapsed_seconds " << snapshot["elapsed"].asDouble() << "\n";
+
+    const std::vector<std::pair<std::string, std::string> > nmetrics = {
+        {"calls", "counter"}, {"fired", "counter"}, {"seconds", "counter"},
+        {"rate", "gauge"}, {"busy", "gauge"}};
+    for (const auto& m : nmetrics) {
+        std::string name = "pgraph_node_" + m.first;
+        if (m.second == "counter") {
+            name += "_total";
+        }
+        ss << "# TYPE " << name << " " << m.second << "\n";
+        for (auto jnode : snapshot["nodes"]) {
+            ss << name
+               << "{node=\"" << label(jnode["node"].asString()) << "\"} "
+               << jnode[m.first].asDouble() << "\n";
+        }
+    }
+    ss << "# TYPE pgraph_edge_depth gauge\n";
+    for (auto jedge : snapshot["edges"]) {
+        ss << "pgraph_edge_depth"
+           << "{tail=\"" << label(jedge["tail"].asString())
+           << "\",tport=\"" << jedge["tport"].asInt()
+           << "\",head=\"" << label(jedge["head"].asString())
+           << "\",hport=\"" << jedge["hport"].asInt() << "\"} "
+           << jedge["depth"].asUInt64() << "\n";
+    }
+    return ss.str();
+}
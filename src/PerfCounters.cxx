@@ -0,0 +1,112 @@
+#include "WireCellPgraph/PerfCounters.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <cstring>
+
+using namespace WireCell::Pgraph;
+
+PerfCounters& PerfCounters::thread_counters()
+{
+    thread_local PerfCounters counters;
+    return counters;
+}
+
+#ifdef __linux__
+
+PerfCounters::PerfCounters()
+    : m_hardware(false)
+{
+    std::vector<std::pair<uint32_t, uint64_t> > hw = {
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+        {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES},
+    };
+    if (open(hw)) {
+        m_hardware = true;
+        m_names = {"cycles", "instructions", "cache_misses", "context_switches"};
+        return;
+    }
+    std::vector<std::pair<uint32_t, uint64_t> > sw = {
+        {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK},
+        {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS},
+        {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES},
+    };
+    if (open(sw)) {
+        m_names = {"task_clock_ns", "page_faults", "context_switches"};
+    }
+}
+
+PerfCounters::~PerfCounters()
+{
+    close();
+}
+
+// Open the events as one group on the calling thread, any CPU.
+bool PerfCounters::open(const std::vector<std::pair<uint32_t, uint64_t> >& events)
+{
+    int leader = -1;
+    for (const auto& ev : events) {
+        struct perf_event_attr pea;
+        memset(&pea, 0, sizeof(pea));
+        pea.size = sizeof(pea);
+        pea.type = ev.first;
+        pea.config = ev.second;
+        pea.disabled = leader < 0 ? 1 : 0;
+        pea.exclude_kernel = 1;
+        pea.exclude_hv = 1;
+        pea.read_format = PERF_FORMAT_GROUP;
+        int fd = syscall(__NR_perf_event_open, &pea, 0, -1, leader, 0);
+        if (fd < 0) {
+            close();
+            return false;
+        }
+        if (leader < 0) {
+            leader = fd;
+        }
+        m_fds.push_back(fd);
+    }
+    ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    m_buf.resize(1 + m_fds.size());
+    return true;
+}
+
+void PerfCounters::close()
+{
+    for (int fd : m_fds) {
+        ::close(fd);
+    }
+    m_fds.clear();
+}
+
+void PerfCounters::read(std::vector<uint64_t>& vals)
+{
+    vals.resize(m_names.size(), 0);
+    if (m_fds.empty()) {
+        return;
+    }
+    size_t want = m_buf.size()*sizeof(uint64_t);
+    if (::read(m_fds[0], m_buf.data(), want) != (ssize_t)want) {
+        return;
+    }
+    for (size_t ind=0; ind<vals.size(); ++ind) {
+        vals[ind] = m_buf[ind+1];
+    }
+}
+
+#else  // not linux
+
+PerfCounters::PerfCounters() : m_hardware(false) {}
+PerfCounters::~PerfCounters() {}
+bool PerfCounters::open(const std::vector<std::pair<uint32_t, uint64_t> >& events) { return false; }
+void PerfCounters::close() {}
+void PerfCounters::read(std::vector<uint64_t>& vals) { vals.clear(); }
+
+#endif
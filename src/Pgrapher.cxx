@@ -1,8 +1,18 @@
 #include "WireCellPgraph/Pgrapher.h"
 #include "WireCellPgraph/Factory.h"
+#include "WireCellPgraph/Recording.h"
+#include "WireCellPgraph/Affinity.h"
+#include "WireCellPgraph/Executor.h"
+#include "WireCellPgraph/Autotune.h"
+#include "WireCellPgraph/ICheckpointable.h"
 #include "WireCellIface/INode.h"
 #include "WireCellUtil/NamedFactory.h"
 
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <set>
+
 WIRECELL_FACTORY(Pgrapher, WireCell::Pgraph::Pgrapher,
                  WireCell::IApplication, WireCell::IConfigurable)
 
@@ -14,6 +24,104 @@ WireCell::Configuration Pgrapher::default_configuration() const
     Configuration cfg;
 
     cfg["edges"] = Json::arrayValue;
+    // The execution engine: "push" calls nodes from the bottom of
+    // the graph up, "pull" propagates demand from the sinks and
+    // "sdf" is like "push" but runs fixed-rate subgraphs from a
+    // static schedule.
+    cfg["engine"] = "push";
+    // Edges to record, each as {tail:{node:..., port:...}, file:...}.
+    cfg["taps"] = Json::arrayValue;
+    // Recordings to replay, each as {head:{node:..., port:...},
+    // file:..., preload:true}.
+    cfg["replays"] = Json::arrayValue;
+    // Function nodes to cache on disk, each as {node:..., config:...}
+    // where config is required and must be the node's own.  A maxbytes of zero
+    // means no limit on the size of the cache.
+    cfg["cache"]["dir"] = "pgraph-cache";
+    cfg["cache"]["maxbytes"] = 0;
+    cfg["cache"]["nodes"] = Json::arrayValue;
+    // Edges on which to shed data, each as {node:..., port:...} of
+    // the tail, while the latency to sinks exceeds "latency" seconds
+    // or any edge holds more than "depth" data, passing one in every
+    // "prescale" or, if zero, none.  A limit of zero is not applied.
+    cfg["shed"]["edges"] = Json::arrayValue;
+    cfg["shed"]["latency"] = 0.0;
+    cfg["shed"]["depth"] = 0;
+    cfg["shed"]["prescale"] = 0;
+    // If not empty, run only these nodes and those upstream of them.
+    cfg["targets"] = Json::arrayValue;
+    // If true, report any data left in the graph after execution.
+    cfg["diagnose"] = true;
+    // If positive, warn when no node makes progress for this many
+    // seconds.
+    cfg["watchdog"] = 0.0;
+    // If true, report latency percentiles from source to each sink.
+    cfg["latency"] = false;
+    // If true, report per node call counts and times.
+    cfg["statistics"] = false;
+    // If true, also count per node CPU events, see PerfCounters.
+    cfg["counters"] = false;
+    // If true, also account heap allocations per node, see
+    // AllocTracker.
+    cfg["allocations"] = false;
+    // If true, call prepare() on all nodes implementing IPreparable,
+    // concurrently, before executing.
+    cfg["prepare"] = false;
+    // Number of threads for the Pgrapher thread pool, zero means one
+    // per hardware thread.
+    cfg["threads"] = 0;
+    // If true, give the pool to nodes implementing IContextual for
+    // their own parallel work.
+    cfg["share_pool"] = false;
+    // If true, give nodes implementing IContextual a BufferPool
+    // holding at most "maxbytes" of free buffers, zero for no limit.
+    cfg["buffers"]["enable"] = false;
+    cfg["buffers"]["maxbytes"] = 0;
+    // If "file" is not empty, write a snapshot of node rates, busy
+    // fractions and edge depths to it every "interval" seconds in
+    // "json" or "prometheus" format.
+    cfg["metrics"]["file"] = "";
+    cfg["metrics"]["interval"] = 10.0;
+    cfg["metrics"]["format"] = "json";
+    // If not empty, write the graph in GraphViz DOT format to this
+    // file when configured and again, annotated with measurements,
+    // after execution.
+    cfg["dot"] = "";
+    // If "file" is not empty, write a checkpoint to it at the first
+    // safe point after every "interval" seconds and, if "resume",
+    // resume from it if it exists.  Only for the push engine.
+    cfg["checkpoint"]["file"] = "";
+    cfg["checkpoint"]["interval"] = 600.0;
+    cfg["checkpoint"]["resume"] = true;
+    // If not empty, run this graph together with those of other
+    // Pgraphers naming the same executor on one pool of "threads"
+    // workers, see Executor.  The "weight" sets the share of the
+    // workers given to this graph and "tenant" names it in reports.
+    // If positive, "quantum" sets the node calls per step of this
+    // graph when run by the executor.
+    cfg["executor"] = "";
+    cfg["weight"] = 1.0;
+    cfg["tenant"] = "pgrapher";
+    cfg["quantum"] = 0;
+    // If not empty, save a profile of node busy times to this file
+    // after execution.  See Autotune.
+    cfg["profile"] = "";
+    // If "overlay" is not empty, write to it settings tuned to the
+    // profile in "profile", in which case the graph is not run, or
+    // else to that of this run.  If "shards" is more than one, also
+    // suggest that many shards.
+    cfg["autotune"]["overlay"] = "";
+    cfg["autotune"]["profile"] = "";
+    cfg["autotune"]["shards"] = 0;
+    // Open ports for a host, each as {name:..., head:{node:...,
+    // port:...}} for ingress and {name:..., tail:{...}} for egress.
+    cfg["ingress"] = Json::arrayValue;
+    cfg["egress"] = Json::arrayValue;
+    // Lists of nodes to run in separate processes, the first in this
+    // one.  Unlisted nodes join a connected shard.  A shard may
+    // instead be given as {nodes:[...], cpus:"0-7", numa:0} to place
+    // it.  See Sharding.
+    cfg["shards"] = Json::arrayValue;
     return cfg;
 }
 
@@ -36,38 +144,514 @@ std::pair<WireCell::INode::pointer, int> get_node(WireCell::Configuration jone)
 void Pgrapher::configure(const WireCell::Configuration& cfg)
 
 {
-    Pgraph::Factory fac;
+    m_engine = get<std::string>(cfg, "engine", "push");
+    if (m_engine != "push" and m_engine != "pull" and m_engine != "sdf") {
+        l->critical("unknown engine: \"{}\"", m_engine);
+        THROW(ValueError() << errmsg{"unknown engine"});
+    }
+
+    std::map<std::pair<INode::pointer, int>, std::string> taps;
+    for (auto jtap : cfg["taps"]) {
+        taps[get_node(jtap["tail"])] = jtap["file"].asString();
+    }
+
+    auto jshed = cfg["shed"];
+    std::set<std::pair<INode::pointer, int> > shed;
+    for (auto jone : jshed["edges"]) {
+        shed.insert(get_node(jone));
+    }
+    ShedPolicy policy;
+    policy.latency = get(jshed, "latency", 0.0);
+    policy.depth = get(jshed, "depth", 0);
+    policy.prescale = get(jshed, "prescale", 0);
+    if (shed.size() and cfg["shards"].size()) {
+        l->critical("can not shed with shards");
+        THROW(ValueError() << errmsg{"can not shed with shards"});
+    }
+
+    m_diagnose = get(cfg, "diagnose", true);
+    m_prepare = get(cfg, "prepare", false);
+    m_nthreads = get(cfg, "threads", 0);
+    m_share_pool = get(cfg, "share_pool", false);
+    if (get(cfg["buffers"], "enable", false)) {
+        m_buffers = std::make_shared<BufferPool>(
+            (size_t)get<double>(cfg["buffers"], "maxbytes", 0));
+    }
+    m_graph.set_watchdog(get(cfg, "watchdog", 0.0));
+
+    Pgraph::Factory fac(m_graph);
+
+    auto jcache = cfg["cache"];
+    if (jcache["nodes"].size()) {
+        auto store = std::make_shared<DiskCache>(
+            get<std::string>(jcache, "dir", "pgraph-cache"),
+            (size_t)get<double>(jcache, "maxbytes", 0));
+        Json::StreamWriterBuilder jwb;
+        jwb["indentation"] = "";
+        for (auto jnode : jcache["nodes"]) {
+            auto nptr = get_node(jnode).first;
+            if (nptr->category() != INode::functionNode) {
+                l->critical("can only cache function nodes: {}", jnode["node"]);
+                THROW(ValueError() << errmsg{"can only cache function nodes"});
+            }
+            if (jnode["config"].isNull()) {
+                l->critical("cached node needs its config: {}", jnode["node"]);
+                THROW(ValueError() << errmsg{"cached node needs its config"});
+            }
+            std::string key = jnode["node"].asString() + "\n"
+                + Json::writeString(jwb, jnode["config"]);
+            auto cf = m_graph.make_node<CachedFunction>(nptr, store, key);
+            m_cached.push_back(cf);
+            fac.bind_node(nptr, cf);
+        }
+        m_cache = store;
+    }
+
+    std::set<std::pair<INode::pointer, int> > replayed;
+    for (auto jrep : cfg["replays"]) {
+        auto head = get_node(jrep["head"]);
+        std::string file = jrep["file"].asString();
+        auto rep = m_graph.make_node<Replayer>(file, get(jrep, "preload", true));
+        l->debug("replaying {}", file);
+        m_graph.connect(rep, fac(head.first), 0, head.second);
+        replayed.insert(head);
+    }
+
     l->debug("connecting: {} edges", cfg["edges"].size());
     for (auto jedge : cfg["edges"]) {
         auto tail = get_node(jedge["tail"]);
         auto head = get_node(jedge["head"]);
 
         SPDLOG_LOGGER_TRACE(l,"connecting: {}", jedge);
+
+        if (replayed.count(head)) {
+            l->critical("edge into replayed port: {}", jedge);
+            THROW(ValueError() << errmsg{"edge into replayed port"});
+        }
+
+        Node* tnode = fac(tail.first);
+        size_t tport = tail.second;
+        if (shed.count(tail)) {
+            auto shedder = m_graph.make_node<Shedder>(tnode->oport(tport).signature(),
+                                                      m_graph, policy);
+            m_shedders.push_back(shedder);
+            m_graph.connect(tnode, shedder, tport, 0);
+            tnode = shedder;
+            tport = 0;
+        }
+        auto tit = taps.find(tail);
+        if (tit != taps.end()) {
+            auto rec = m_graph.make_node<Recorder>(tnode->oport(tport).signature(), tit->second);
+            l->debug("recording to {}", tit->second);
+            m_graph.connect(tnode, rec, tport, 0);
+            tnode = rec;
+            tport = 0;
+            taps.erase(tit);
+        }
         
-        bool ok = m_graph.connect(fac(tail.first),  fac(head.first),
-                                  tail.second, head.second);
+        bool ok = m_graph.connect(tnode,  fac(head.first),
+                                  tport, head.second);
         if (!ok) {
             l->critical("failed to connect edge: {}", jedge);
             THROW(ValueError() << errmsg{"failed to connect edge"});
         }
     }
+    if (!taps.empty()) {
+        l->critical("tap on no edge, recording to: {}", taps.begin()->second);
+        THROW(ValueError() << errmsg{"tap on no edge"});
+    }
+    for (auto jedge : cfg["edges"]) {
+        for (auto end : {"tail", "head"}) {
+            m_names[fac(get_node(jedge[end]).first)] = jedge[end]["node"].asString();
+        }
+    }
+    m_graph.set_names(m_names);
+    m_profile = get<std::string>(cfg, "profile", "");
+    m_overlay = get<std::string>(cfg["autotune"], "overlay", "");
+    m_tune_profile = get<std::string>(cfg["autotune"], "profile", "");
+    m_tune_shards = get(cfg["autotune"], "shards", 0);
+
+    for (auto jing : cfg["ingress"]) {
+        auto head = get_node(jing["head"]);
+        m_graph.add_ingress(jing["name"].asString(), fac(head.first), head.second);
+    }
+    for (auto jeg : cfg["egress"]) {
+        auto tail = get_node(jeg["tail"]);
+        m_graph.add_egress(jeg["name"].asString(), fac(tail.first), tail.second);
+    }
+
     if (!m_graph.connected()) {
         l->critical("graph not fully connected");
         THROW(ValueError() << errmsg{"graph not fully connected"});
     }
+    if (cfg["targets"].size()) {
+        std::vector<Node*> targets;
+        for (auto jnode : cfg["targets"]) {
+            Configuration jone;
+            jone["node"] = jnode;
+            targets.push_back(fac(get_node(jone).first));
+        }
+        size_t nremoved = m_graph.prune(targets);
+        l->info("running {} targets, pruned {} nodes not upstream of them",
+                targets.size(), nremoved);
+    }
+    if (cfg["shards"].size()) {
+        if (cfg["ingress"].size() or cfg["egress"].size()) {
+            l->critical("host ports can not be used with shards");
+            THROW(ValueError() << errmsg{"host ports can not be used with shards"});
+        }
+        std::unordered_map<Node*, int> assignment;
+        int shard = 0;
+        for (auto jshard : cfg["shards"]) {
+            auto jnodes = jshard.isArray() ? jshard : jshard["nodes"];
+            for (auto jnode : jnodes) {
+                Configuration jone;
+                jone["node"] = jnode;
+                assignment[fac(get_node(jone).first)] = shard;
+            }
+            ++shard;
+        }
+        m_sharding.reset(new Sharding(m_graph, assignment));
+        if (m_share_pool) {
+            m_sharding->set_threads(m_nthreads);
+        }
+        if (m_buffers) {
+            m_sharding->set_buffers(m_buffers);
+        }
+        shard = 0;
+        for (auto jshard : cfg["shards"]) {
+            if (jshard.isObject()) {
+                ShardPlacement sp;
+                sp.cpus = parse_cpus(get<std::string>(jshard, "cpus", ""));
+                sp.numa = get(jshard, "numa", -1);
+                m_sharding->place(shard, sp);
+            }
+            ++shard;
+        }
+        l->debug("{} shards with {} edges between them",
+                 m_sharding->size(), m_sharding->crossings());
+        if (m_engine != "push") {
+            l->warn("shards run with the push engine, not \"{}\"", m_engine);
+        }
+    }
+
+    m_executor = get<std::string>(cfg, "executor", "");
+    if (!m_executor.empty()) {
+        if (m_sharding) {
+            l->critical("an executor can not be used with shards");
+            THROW(ValueError() << errmsg{"an executor can not be used with shards"});
+        }
+        if (m_engine != "push") {
+            l->warn("executor runs the push engine, not \"{}\"", m_engine);
+        }
+        auto& ex = Executor::named(m_executor);
+        ex.set_threads(m_nthreads);
+        int quantum = get(cfg, "quantum", 0);
+        ex.add(&m_graph, get<std::string>(cfg, "tenant", "pgrapher"),
+               get(cfg, "weight", 1.0), [this]() { setup(); },
+               quantum > 0 ? quantum : 0);
+    }
+
+    auto jmet = cfg["metrics"];
+    std::string metrics = get<std::string>(jmet, "file", "");
+    if (!metrics.empty()) {
+        double interval = get(jmet, "interval", 10.0);
+        std::string format = get<std::string>(jmet, "format", "json");
+        if (m_sharding) {
+            m_sharding->set_metrics(metrics, interval, format);
+        }
+        else {
+            m_graph.set_metrics(metrics, interval, format);
+        }
+    }
+
+    m_dot = get<std::string>(cfg, "dot", "");
+    write_dot();
+
+    m_checkpoint = get<std::string>(cfg["checkpoint"], "file", "");
+    m_resume = false;
+    if (!m_checkpoint.empty()) {
+        if (m_sharding or m_engine != "push") {
+            l->critical("checkpoints need the push engine without shards");
+            THROW(ValueError() << errmsg{"checkpoints need the push engine without shards"});
+        }
+        for (auto jedge : cfg["edges"]) {
+            auto tail = get_node(jedge["tail"]).first;
+            if (tail->category() == INode::sourceNode
+                and !std::dynamic_pointer_cast<ICheckpointable>(tail)) {
+                l->critical("checkpoints need sources to be checkpointable: {}",
+                            jedge["tail"]["node"]);
+                THROW(ValueError() << errmsg{"checkpoints need sources to be checkpointable"});
+            }
+        }
+        m_graph.set_checkpoint(m_checkpoint, get(cfg["checkpoint"], "interval", 600.0));
+        m_resume = get(cfg["checkpoint"], "resume", true);
+    }
+
+    if (get(cfg, "latency", false) or (m_shedders.size() and policy.latency > 0)) {
+        m_graph.enable_latency();
+    }
+    m_statistics = get(cfg, "statistics", false);
+    if (get(cfg, "counters", false)) {
+        m_graph.enable_counters();
+        m_statistics = true;
+    }
+    if (get(cfg, "allocations", false)) {
+        if (m_graph.enable_alloc_tracking()) {
+            m_statistics = true;
+        }
+        else {
+            l->warn("allocation tracking unavailable, preload libWireCellPgraphAlloc to enable it");
+        }
+    }
+    if (m_statistics or !m_profile.empty() or !m_overlay.empty() or !m_dot.empty()) {
+        m_graph.enable_stats();
+    }
+}
+
+
+
+void Pgrapher::setup()
+{
+    if (m_prepare) {
+        m_graph.prepare(pool());
+    }
+    if ((m_share_pool or m_buffers) and !m_sharding) {
+        Context ctx;
+        if (m_share_pool) {
+            pool();
+            ctx.pool = m_pool;
+        }
+        ctx.buffers = m_buffers;
+        m_graph.set_context(ctx);
+    }
+    if (m_resume) {
+        std::ifstream fi(m_checkpoint, std::ios::binary);
+        if (fi) {
+            m_graph.load_checkpoint(fi);
+            l->info("resuming from checkpoint {}", m_checkpoint);
+        }
+    }
 }
 
+static WireCell::Configuration read_json(const std::string& filename)
+{
+    using namespace WireCell;
+    std::ifstream fi(filename);
+    Configuration ret;
+    Json::CharReaderBuilder jrb;
+    std::string errs;
+    if (!fi or !Json::parseFromStream(jrb, fi, &ret, &errs)) {
+        THROW(IOError() << errmsg{"failed to read JSON from " + filename});
+    }
+    return ret;
+}
 
+static void write_json(const std::string& filename, const WireCell::Configuration& cfg)
+{
+    using namespace WireCell;
+    std::ofstream fo(filename);
+    fo << cfg << std::endl;
+    if (!fo) {
+        THROW(IOError() << errmsg{"failed to write JSON to " + filename});
+    }
+}
 
 void Pgrapher::execute()
 {
-    m_graph.execute();
+    if (!m_overlay.empty() and !m_tune_profile.empty()) {
+        // Tune from an earlier run without running.
+        write_json(m_overlay, tune(read_json(m_tune_profile)));
+        l->info("wrote overlay tuned to {} to {}", m_tune_profile, m_overlay);
+        return;
+    }
+
+    if (!m_executor.empty()) {
+        // The first Pgrapher to execute runs all graphs.
+        auto& ex = Executor::named(m_executor);
+        if (ex.pending(&m_graph)) {
+            auto stats = ex.run();
+            for (auto jt : stats["graphs"]) {
+                l->info("executor \"{}\" ran {} with weight {}: steps: {} calls: {} fired: {} time: {:.3f} s",
+                        m_executor, jt["name"].asString(), jt["weight"].asDouble(),
+                        jt["steps"].asUInt64(), jt["calls"].asUInt64(),
+                        jt["fired"].asUInt64(), jt["seconds"].asDouble());
+            }
+        }
+        report();
+        return;
+    }
+
+    setup();
+
+    if (m_sharding) {
+        execute_shards();
+        if (!m_profile.empty() or !m_overlay.empty()) {
+            l->warn("no profile is made of a sharded run");
+        }
+        return;
+    }
+
+    if (m_engine == "pull") {
+        m_graph.execute_pull();
+    }
+    else if (m_engine == "sdf") {
+        m_graph.execute_sdf();
+    }
+    else {
+        m_graph.execute();
+    }
+    report();
 }
 
+void Pgrapher::report()
+{
+    if (m_diagnose) {
+        auto diag = m_graph.diagnose();
+        if (diag["stalled"].asBool()) {
+            l->warn("graph finished with data on {} edges, {} nodes waiting, {} wait cycles:\n{}",
+                    diag["edges"].size(), diag["waiting"].size(),
+                    diag["cycles"].size(), diag);
+        }
+    }
 
+    if (m_statistics) {
+        Json::StreamWriterBuilder jwb;
+        jwb["indentation"] = "";
+        auto stats = m_graph.statistics();
+        for (auto jnode : stats["nodes"]) {
+            l->info("calls: {} fired: {} time: {:.3f} s counters: {} alloc: {} for {}",
+                    jnode["calls"].asUInt64(), jnode["fired"].asUInt64(),
+                    jnode["seconds"].asDouble(),
+                    Json::writeString(jwb, jnode["counters"]),
+                    Json::writeString(jwb, jnode["alloc"]),
+                    jnode["node"].asString());
+        }
+    }
+
+    for (const auto& it : m_graph.latencies()) {
+        const auto& lh = it.second;
+        l->info("latency p50: {:.6f} p99: {:.6f} max: {:.6f} s over {} items to {}",
+                lh.quantile(0.5), lh.quantile(0.99), lh.max(),
+                lh.count(), it.first->ident());
+    }
+
+    size_t nshed = 0;
+    for (auto sh : m_shedders) {
+        l->info("shed: {} passed: {} at {}", sh->shed(), sh->passed(), sh->ident());
+        nshed += sh->shed();
+    }
+    if (m_shedders.size()) {
+        l->info("shed {} data in total", nshed);
+    }
+
+    for (auto cf : m_cached) {
+        l->info("cache hits: {} misses: {} for {}",
+                cf->hits(), cf->misses(), cf->ident());
+    }
+    if (m_cache) {
+        l->info("cache total hits: {} misses: {} evictions: {} size: {} bytes",
+                m_cache->hits(), m_cache->misses(),
+                m_cache->evictions(), m_cache->bytes());
+    }
+
+    write_dot();
+
+    if (!m_checkpoint.empty()) {
+        // Done, so a later run must start afresh.
+        l->info("wrote {} checkpoints to {}", m_graph.checkpoints(), m_checkpoint);
+        std::remove(m_checkpoint.c_str());
+    }
+
+    if (m_buffers) {
+        l->info("buffer pool hits: {} misses: {} held: {} bytes",
+                m_buffers->hits(), m_buffers->misses(), m_buffers->held());
+    }
+
+    if (!m_profile.empty() or !m_overlay.empty()) {
+        auto profile = make_profile(m_graph, m_names);
+        if (!m_profile.empty()) {
+            write_json(m_profile, profile);
+            l->info("wrote profile to {}", m_profile);
+        }
+        if (!m_overlay.empty()) {
+            write_json(m_overlay, tune(profile));
+            l->info("wrote overlay tuned to this run to {}", m_overlay);
+        }
+    }
+}
+
+
+
+WireCell::Configuration Pgrapher::tune(const WireCell::Configuration& profile)
+{
+    auto overlay = autotune(m_graph, m_names, profile, m_tune_shards);
+    if (!m_prepare and !m_share_pool and m_executor.empty()) {
+        overlay.removeMember("threads");
+    }
+    return overlay;
+}
+
+void Pgrapher::execute_shards()
+{
+    auto stats = m_sharding->execute();
+    bool failed = false;
+    for (auto jshard : stats["shards"]) {
+        l->info("shard {} pid {} status {} numa {}: nodes: {} calls: {} fired: {} sent: {} received: {} crossed: {} time: {:.3f} s",
+                jshard["shard"].asInt(), jshard["pid"].asInt(),
+                jshard["status"].asInt(), jshard["domain"].asInt(),
+                jshard["nodes"].asInt(),
+                jshard["calls"].asUInt64(), jshard["fired"].asUInt64(),
+                jshard["sent"].asUInt64(), jshard["received"].asUInt64(),
+                jshard["crossed"].asUInt64(),
+                jshard["seconds"].asDouble());
+        if (m_diagnose and jshard["stalled"].asBool()) {
+            l->warn("shard {} finished with data left on its edges",
+                    jshard["shard"].asInt());
+        }
+        if (m_statistics) {
+            for (auto jnode : jshard["stats"]) {
+                l->info("shard {} calls: {} fired: {} time: {:.3f} s for {}",
+                        jshard["shard"].asInt(),
+                        jnode["calls"].asUInt64(), jnode["fired"].asUInt64(),
+                        jnode["seconds"].asDouble(), jnode["node"].asString());
+            }
+        }
+        failed = failed or jshard["status"].asInt() != 0;
+    }
+    if (failed) {
+        THROW(RuntimeError() << errmsg{"pgraph shard failed"});
+    }
+}
+
+void Pgrapher::write_dot()
+{
+    if (m_dot.empty()) {
+        return;
+    }
+    std::ofstream fo(m_dot);
+    m_graph.write_dot(fo);
+    if (!fo) {
+        l->warn("failed to write graph to {}", m_dot);
+    }
+}
+
+ThreadPool& Pgrapher::pool()
+{
+    if (!m_pool and !m_executor.empty()) {
+        m_pool = Executor::named(m_executor).pool();
+    }
+    if (!m_pool) {
+        m_pool = std::make_shared<ThreadPool>(m_nthreads);
+    }
+    return *m_pool;
+}
 
 Pgrapher::Pgrapher()
-    : l(Log::logger("pgraph"))
+    : m_diagnose(true), m_statistics(false), m_prepare(false)
+    , m_share_pool(false)
+    , m_nthreads(0), m_tune_shards(0)
+    , l(Log::logger("pgraph"))
 {
 }
 Pgrapher::~Pgrapher()
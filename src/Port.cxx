@@ -1,7 +1,9 @@
 #include "WireCellPgraph/Port.h"
+#include "WireCellPgraph/Node.h"
 
 
 #include <iostream>
+#include <utility>
 
 using namespace std;
 using namespace WireCell::Pgraph;
@@ -12,6 +14,9 @@ Port::Port(Node* node, Type type, std::string signature, std::string name)
     , m_name(name)
     , m_sig(signature)
     , m_edge(nullptr)
+    , m_stamps(nullptr)
+    , m_peak(0)
+    , m_discard(false)
 { }
                 
 bool Port::isinput() { return m_type == Port::input; }
@@ -26,6 +31,10 @@ Edge Port::plug(Edge edge) {
     return ret;
 }
 
+void Port::plug_stamps(Stamps stamps) {
+    m_stamps = stamps;
+}
+
 // return edge queue size or 0 if no edge has been plugged
 size_t Port::size() {
     if (!m_edge) { return 0; }
@@ -51,22 +60,47 @@ Data Port::get(bool pop) {
     if (m_edge->empty()) {
         THROW(RuntimeError() << errmsg{"edge is empty"});
     }
-    Data ret = m_edge->front();
-    if (pop) {
-        m_edge->pop_front();
+    if (!pop) {
+        return m_edge->front();
+    }
+    Data ret = std::move(m_edge->front());
+    m_edge->pop_front();
+    if (m_stamps and !m_stamps->empty()) {
+        m_node->consumed(m_stamps->front());
+        m_stamps->pop_front();
     }
     return ret;
 }
 
 // Put the data onto the queue.
 void Port::put(Data& data) {
+    Data copy = data;
+    put(std::move(copy));
+}
+
+// Move the data onto the queue.
+void Port::put(Data&& data) {
     if (isinput()) {
         THROW(RuntimeError() << errmsg{"can not put to input port"});
     }
     if (!m_edge) {
         THROW(RuntimeError() << errmsg{"port has no edge"});
     }
-    m_edge->push_back(data);
+    if (m_discard) {
+        return;
+    }
+    m_edge->push_back(std::move(data));
+    if (m_edge->size() > m_peak) {
+        m_peak = m_edge->size();
+    }
+    if (m_stamps) {
+        Stamp stamp;
+        if (!m_node->origin(stamp)) {
+            stamp = std::chrono::steady_clock::now(); // a source
+        }
+        m_stamps->push_back(stamp);
+        m_node->sent(stamp);
+    }
 }
 
 const std::string& Port::name() { return m_name; }
@@ -0,0 +1,140 @@
+#include "WireCellPgraph/Recording.h"
+#include "WireCellUtil/Type.h"
+
+#include <sstream>
+
+using WireCell::demangle;
+using namespace WireCell::Pgraph;
+
+Recorder::Recorder(const std::string& signature, const std::string& filename)
+    : m_filename(filename)
+    , m_out(filename, std::ios::binary)
+    , m_ser(Serializers::instance().get(signature))
+{
+    if (!m_out) {
+        THROW(IOError() << errmsg{"failed to open for writing: " + filename});
+    }
+    write_header(m_out, signature);
+    m_ports[Port::input].push_back(Port(this, Port::input, signature));
+    m_ports[Port::output].push_back(Port(this, Port::output, signature));
+}
+
+Recorder::~Recorder()
+{
+}
+
+bool Recorder::operator()()
+{
+    if (!oport().empty()) {
+        return false; // don't call me if I've got existing output waiting
+    }
+    if (iport().empty()) {
+        return false; // don't call me if there is nothing to give me.
+    }
+    return fire();
+}
+
+bool Recorder::fire()
+{
+    auto data = iport().get();
+    m_ser->write(m_out, data);
+    if (m_ser->eos(data)) {
+        m_out.flush();
+    }
+    oport().put(data);
+    return true;
+}
+
+std::string Recorder::ident()
+{
+    std::stringstream ss;
+    ss << "<Recorder sig:" << demangle(iport().signature())
+       << " file:" << m_filename << ">";
+    return ss.str();
+}
+
+
+Replayer::Replayer(const std::string& filename, bool preload)
+    : m_filename(filename)
+    , m_in(filename, std::ios::binary)
+    , m_ser(nullptr)
+    , m_preload(preload)
+    , m_given(0)
+{
+    if (!m_in) {
+        THROW(IOError() << errmsg{"failed to open for reading: " + filename});
+    }
+    std::string signature = read_header(m_in);
+    m_ser = Serializers::instance().get(signature);
+    m_ports[Port::output].push_back(Port(this, Port::output, signature));
+
+    if (m_preload) {
+        Data data;
+        while (next(data)) {
+            m_loaded.push_back(data);
+        }
+        m_in.close();
+    }
+}
+
+Replayer::~Replayer()
+{
+}
+
+bool Replayer::next(Data& data)
+{
+    if (m_preload and !m_in.is_open()) {
+        if (m_loaded.empty()) {
+            return false;
+        }
+        data = m_loaded.front();
+        m_loaded.pop_front();
+        return true;
+    }
+    if (m_in.peek() == std::ifstream::traits_type::eof()) {
+        return false;
+    }
+    data = m_ser->read(m_in);
+    return true;
+}
+
+bool Replayer::operator()()
+{
+    Port& op = oport();
+    if (op.size()) {
+        return false; // don't call me if I've got existing output waiting
+    }
+    Data data;
+    if (!next(data)) {
+        return false;
+    }
+    op.put(data);
+    ++m_given;
+    return true;
+}
+
+bool Replayer::save_state(std::string& state)
+{
+    state = std::to_string(m_given);
+    return true;
+}
+
+void Replayer::load_state(const std::string& state)
+{
+    size_t given = std::stoull(state);
+    Data data;
+    while (m_given < given) {
+        if (!next(data)) {
+            THROW(ValueError() << errmsg{"replay file too short to resume: " + m_filename});
+        }
+        ++m_given;
+    }
+}
+
+std::string Replayer::ident()
+{
+    std::stringstream ss;
+    ss << "<Replayer sig:" << demangle(oport().signature())
+       << " file:" << m_filename << ">";
+    return ss.str();
+}
@@ -0,0 +1,267 @@
+#include "WireCellPgraph/Serializer.h"
+
+#include "WireCellIface/IDepo.h"
+#include "WireCellIface/IFrame.h"
+#include "WireCellIface/SimpleDepo.h"
+#include "WireCellIface/SimpleFrame.h"
+#include "WireCellIface/SimpleTrace.h"
+#include "WireCellUtil/Type.h"
+
+#include <cstdint>
+
+using namespace WireCell;
+using namespace WireCell::Pgraph;
+
+static const char* header_magic = "WCPGRAPH";
+
+template<typename T>
+static void put(std::ostream& so, const T& val)
+{
+    so.write(reinterpret_cast<const char*>(&val), sizeof(T));
+}
+static void put(std::ostream& so, const std::string& str)
+{
+    put<uint64_t>(so, str.size());
+    so.write(str.data(), str.size());
+}
+template<typename T>
+static void put(std::ostream& so, const std::vector<T>& vec)
+{
+    put<uint64_t>(so, vec.size());
+    so.write(reinterpret_cast<const char*>(vec.data()), vec.size()*sizeof(T));
+}
+
+static void check(std::istream& si)
+{
+    if (!si) {
+        THROW(IOError() << errmsg{"pgraph serializer: premature end of stream"});
+    }
+}
+template<typename T>
+static T take(std::istream& si)
+{
+    T val;
+    si.read(reinterpret_cast<char*>(&val), sizeof(T));
+    check(si);
+    return val;
+}
+static std::string take_string(std::istream& si)
+{
+    std::string str(take<uint64_t>(si), 0);
+    si.read(&str[0], str.size());
+    check(si);
+    return str;
+}
+template<typename T>
+static std::vector<T> take_vector(std::istream& si)
+{
+    std::vector<T> vec(take<uint64_t>(si));
+    si.read(reinterpret_cast<char*>(vec.data()), vec.size()*sizeof(T));
+    check(si);
+    return vec;
+}
+
+
+// Serialize shared pointers to IData, with nullptr as end-of-stream.
+template<class IType>
+struct PointerSerializer : public Serializer {
+    typedef typename IType::pointer pointer;
+
+    virtual ~PointerSerializer() {}
+
+    virtual void write(std::ostream& so, const Data& data) {
+        auto obj = boost::any_cast<pointer>(data);
+        put<uint8_t>(so, obj ? 1 : 0);
+        if (obj) {
+            write_object(so, obj);
+        }
+    }
+    virtual Data read(std::istream& si) {
+        pointer obj;
+        if (take<uint8_t>(si)) {
+            obj = read_object(si);
+        }
+        return Data(obj);
+    }
+    virtual bool eos(const Data& data) {
+        return !boost::any_cast<pointer>(data);
+    }
+
+    void write_object(std::ostream& so, const pointer& obj);
+    pointer read_object(std::istream& si);
+};
+
+
+// Depos are written without their prior history.
+template<>
+void PointerSerializer<IDepo>::write_object(std::ostream& so, const IDepo::pointer& depo)
+{
+    const auto& pos = depo->pos();
+    put(so, depo->time());
+    put(so, pos.x());
+    put(so, pos.y());
+    put(so, pos.z());
+    put(so, depo->charge());
+    put(so, depo->energy());
+    put<int32_t>(so, depo->id());
+    put<int32_t>(so, depo->pdg());
+    put(so, depo->extent_long());
+    put(so, depo->extent_tran());
+}
+template<>
+IDepo::pointer PointerSerializer<IDepo>::read_object(std::istream& si)
+{
+    double t = take<double>(si);
+    double x = take<double>(si);
+    double y = take<double>(si);
+    double z = take<double>(si);
+    double charge = take<double>(si);
+    double energy = take<double>(si);
+    int id = take<int32_t>(si);
+    int pdg = take<int32_t>(si);
+    double el = take<double>(si);
+    double et = take<double>(si);
+    return std::make_shared<SimpleDepo>(t, Point(x,y,z), charge, nullptr,
+                                        el, et, id, pdg, energy);
+}
+
+
+template<>
+void PointerSerializer<IFrame>::write_object(std::ostream& so, const IFrame::pointer& frame)
+{
+    put<int32_t>(so, frame->ident());
+    put(so, frame->time());
+    put(so, frame->tick());
+
+    auto traces = frame->traces();
+    size_t ntraces = traces ? traces->size() : 0;
+    put<uint64_t>(so, ntraces);
+    for (size_t ind=0; ind<ntraces; ++ind) {
+        auto trace = traces->at(ind);
+        put<int32_t>(so, trace->channel());
+        put<int32_t>(so, trace->tbin());
+        put(so, trace->charge());
+    }
+
+    auto cmm = frame->masks();
+    put<uint64_t>(so, cmm.size());
+    for (const auto& it : cmm) {
+        put(so, it.first);
+        put<uint64_t>(so, it.second.size());
+        for (const auto& chit : it.second) {
+            put<int32_t>(so, chit.first);
+            put<uint64_t>(so, chit.second.size());
+            for (const auto& br : chit.second) {
+                put<int32_t>(so, br.first);
+                put<int32_t>(so, br.second);
+            }
+        }
+    }
+
+    const auto& ftags = frame->frame_tags();
+    put<uint64_t>(so, ftags.size());
+    for (const auto& tag : ftags) {
+        put(so, tag);
+    }
+    const auto& ttags = frame->trace_tags();
+    put<uint64_t>(so, ttags.size());
+    for (const auto& tag : ttags) {
+        put(so, tag);
+        put(so, frame->tagged_traces(tag));
+        put(so, frame->trace_summary(tag));
+    }
+}
+template<>
+IFrame::pointer PointerSerializer<IFrame>::read_object(std::istream& si)
+{
+    int ident = take<int32_t>(si);
+    double time = take<double>(si);
+    double tick = take<double>(si);
+
+    ITrace::vector traces(take<uint64_t>(si));
+    for (size_t ind=0; ind<traces.size(); ++ind) {
+        int chid = take<int32_t>(si);
+        int tbin = take<int32_t>(si);
+        auto charge = take_vector<ITrace::ChargeSequence::value_type>(si);
+        traces[ind] = std::make_shared<SimpleTrace>(chid, tbin, charge);
+    }
+
+    Waveform::ChannelMaskMap cmm;
+    size_t nmasks = take<uint64_t>(si);
+    for (size_t imask=0; imask<nmasks; ++imask) {
+        auto& cm = cmm[take_string(si)];
+        size_t nchans = take<uint64_t>(si);
+        for (size_t ichan=0; ichan<nchans; ++ichan) {
+            auto& brl = cm[take<int32_t>(si)];
+            size_t nbrs = take<uint64_t>(si);
+            for (size_t ibr=0; ibr<nbrs; ++ibr) {
+                int beg = take<int32_t>(si);
+                int end = take<int32_t>(si);
+                brl.push_back(std::make_pair(beg, end));
+            }
+        }
+    }
+
+    auto sf = std::make_shared<SimpleFrame>(ident, time, traces, tick, cmm);
+
+    size_t nftags = take<uint64_t>(si);
+    for (size_t ind=0; ind<nftags; ++ind) {
+        sf->tag_frame(take_string(si));
+    }
+    size_t nttags = take<uint64_t>(si);
+    for (size_t ind=0; ind<nttags; ++ind) {
+        auto tag = take_string(si);
+        auto indices = take_vector<IFrame::trace_list_t::value_type>(si);
+        auto summary = take_vector<IFrame::trace_summary_t::value_type>(si);
+        sf->tag_traces(tag, indices, summary);
+    }
+    return sf;
+}
+
+
+Serializers& Serializers::instance()
+{
+    static Serializers sers;
+    return sers;
+}
+
+Serializers::Serializers()
+{
+    bind<IDepo::pointer>(new PointerSerializer<IDepo>);
+    bind<IFrame::pointer>(new PointerSerializer<IFrame>);
+    // ...
+}
+
+Serializer* Serializers::find(const std::string& signature)
+{
+    auto it = m_sers.find(signature);
+    if (it == m_sers.end()) {
+        return nullptr;
+    }
+    return it->second.get();
+}
+
+Serializer* Serializers::get(const std::string& signature)
+{
+    auto ser = find(signature);
+    if (!ser) {
+        THROW(ValueError() << errmsg{"no pgraph serializer for " + demangle(signature)});
+    }
+    return ser;
+}
+
+void Pgraph::write_header(std::ostream& so, const std::string& signature)
+{
+    so.write(header_magic, 8);
+    put(so, signature);
+}
+
+std::string Pgraph::read_header(std::istream& si)
+{
+    std::string magic(8, 0);
+    si.read(&magic[0], 8);
+    if (!si or magic != header_magic) {
+        THROW(IOError() << errmsg{"pgraph serializer: not a pgraph data stream"});
+    }
+    return take_string(si);
+}
@@ -0,0 +1,621 @@
+#include "WireCellPgraph/Shard.h"
+#include "WireCellPgraph/Affinity.h"
+#include "WireCellUtil/Type.h"
+
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <sstream>
+
+using WireCell::demangle;
+using namespace WireCell;
+using namespace WireCell::Pgraph;
+
+// Write all bytes, return false on error.
+static bool send_all(int fd, const char* buf, size_t len)
+{
+    while (len) {
+        ssize_t n = ::send(fd, buf, len, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        buf += n;
+        len -= n;
+    }
+    return true;
+}
+
+// Read exactly len bytes.  Return the number read which is less
+// than len only at end of file or on error.
+static size_t read_all(int fd, char* buf, size_t len)
+{
+    size_t got = 0;
+    while (got < len) {
+        ssize_t n = ::read(fd, buf + got, len - got);
+        if (n < 0 and errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            break;
+        }
+        got += n;
+    }
+    return got;
+}
+
+
+ShardSender::ShardSender(const std::string& signature, int fd)
+    : m_fd(fd)
+    , m_ser(Serializers::instance().get(signature))
+    , m_count(0)
+{
+    m_ports[Port::input].push_back(Port(this, Port::input, signature));
+}
+
+ShardSender::~ShardSender()
+{
+    close();
+}
+
+void ShardSender::close()
+{
+    if (m_fd >= 0) {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+}
+
+bool ShardSender::operator()()
+{
+    if (iport().empty()) {
+        return false; // don't call me if there is nothing to give me.
+    }
+    return fire();
+}
+
+bool ShardSender::fire()
+{
+    auto data = iport().get();
+    std::stringstream ss;
+    m_ser->write(ss, data);
+    std::string bytes = ss.str();
+    uint64_t len = bytes.size();
+    if (m_fd < 0
+        or !send_all(m_fd, reinterpret_cast<const char*>(&len), sizeof(len))
+        or !send_all(m_fd, bytes.data(), bytes.size())) {
+        THROW(IOError() << errmsg{"pgraph shard: failed to send " + demangle(iport().signature())});
+    }
+    ++m_count;
+    return true;
+}
+
+std::string ShardSender::ident()
+{
+    std::stringstream ss;
+    ss << "<ShardSender sig:" << demangle(iport().signature()) << ">";
+    return ss.str();
+}
+
+
+ShardReceiver::ShardReceiver(const std::string& signature, int fd,
+                             ShardSignal& signal)
+    : m_fd(fd)
+    , m_ser(Serializers::instance().get(signature))
+    , m_signal(signal)
+    , m_closed(false)
+    , m_count(0)
+{
+    m_ports[Port::output].push_back(Port(this, Port::output, signature));
+    m_thread = std::thread(&ShardReceiver::run, this);
+}
+
+ShardReceiver::~ShardReceiver()
+{
+    // The reader returns once the peer closes its end.
+    m_thread.join();
+    ::close(m_fd);
+}
+
+void ShardReceiver::run()
+{
+    auto l = Log::logger("pgraph");
+    while (true) {
+        uint64_t len = 0;
+        if (read_all(m_fd, reinterpret_cast<char*>(&len), sizeof(len)) != sizeof(len)) {
+            break;              // peer is done
+        }
+        std::string bytes(len, 0);
+        if (read_all(m_fd, &bytes[0], len) != len) {
+            l->error("pgraph shard: truncated datum from peer");
+            break;
+        }
+        std::stringstream ss(bytes);
+        Data data;
+        try {
+            data = m_ser->read(ss);
+        }
+        catch (...) {
+            l->error("pgraph shard: failed to read datum from peer");
+            break;
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_inbox.push_back(data);
+        }
+        std::lock_guard<std::mutex> lock(m_signal.mutex);
+        ++m_signal.arrivals;
+        m_signal.cond.notify_all();
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_closed = true;
+    }
+    std::lock_guard<std::mutex> lock(m_signal.mutex);
+    ++m_signal.arrivals;
+    m_signal.cond.notify_all();
+}
+
+bool ShardReceiver::operator()()
+{
+    if (!oport().empty()) {
+        return false; // don't call me if I've got existing output waiting
+    }
+    Data data;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_inbox.empty()) {
+            return false;
+        }
+        data = m_inbox.front();
+        m_inbox.pop_front();
+    }
+    oport().put(data);
+    ++m_count;
+    return true;
+}
+
+bool ShardReceiver::starved()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_inbox.empty() and !m_closed;
+}
+
+bool ShardReceiver::drained()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_inbox.empty() and m_closed;
+}
+
+std::string ShardReceiver::ident()
+{
+    std::stringstream ss;
+    ss << "<ShardReceiver sig:" << demangle(oport().signature()) << ">";
+    return ss.str();
+}
+
+
+Sharding::Sharding(Graph& graph, const std::unordered_map<Node*, int>& assignment)
+    : m_graph(graph)
+    , m_nshards(1)
+    , m_nthreads(-1)
+    , m_metrics_interval(0)
+    , l(Log::logger("pgraph"))
+{
+    const auto& edges = m_graph.edges();
+
+    // Unassigned nodes join the shard of the nearest assigned node.
+    std::unordered_map<Node*, std::vector<Node*> > neighbors;
+    std::vector<Node*> order;
+    for (const auto& e : edges) {
+        for (Node* node : {e.tail, e.head}) {
+            if (!neighbors.count(node)) {
+                order.push_back(node);
+            }
+        }
+        neighbors[e.tail].push_back(e.head);
+        neighbors[e.head].push_back(e.tail);
+    }
+    std::deque<Node*> todo;
+    for (Node* node : order) {
+        auto it = assignment.find(node);
+        if (it == assignment.end()) {
+            continue;
+        }
+        if (it->second < 0) {
+            THROW(ValueError() << errmsg{"negative shard for " + node->ident()});
+        }
+        m_shard[node] = it->second;
+        m_nshards = std::max(m_nshards, (size_t)it->second + 1);
+        todo.push_back(node);
+    }
+    while (!todo.empty()) {
+        Node* node = todo.front();
+        todo.pop_front();
+        for (Node* other : neighbors[node]) {
+            if (!m_shard.count(other)) {
+                m_shard[other] = m_shard[node];
+                todo.push_back(other);
+            }
+        }
+    }
+    for (Node* node : order) {
+        m_shard.emplace(node, 0);
+    }
+
+    // Crossing edges must be serializable.
+    for (size_t ind=0; ind<edges.size(); ++ind) {
+        const auto& e = edges[ind];
+        if (m_shard[e.tail] == m_shard[e.head]) {
+            continue;
+        }
+        Serializers::instance().get(e.tail->oport(e.tpind).signature());
+        m_cross.push_back(ind);
+    }
+    m_placement.resize(m_nshards);
+}
+
+void Sharding::place(int shard, const ShardPlacement& placement)
+{
+    if (shard < 0 or (size_t)shard >= m_nshards) {
+        THROW(ValueError() << errmsg{"no such shard to place: " + std::to_string(shard)});
+    }
+    m_placement[shard] = placement;
+}
+
+void Sharding::set_metrics(const std::string& filename, double interval,
+                           const std::string& format)
+{
+    m_metrics = filename;
+    m_metrics_interval = interval;
+    m_metrics_format = format;
+}
+
+int Sharding::domain(int shard) const
+{
+    const auto& sp = m_placement[shard];
+    if (sp.numa >= 0) {
+        return sp.numa;
+    }
+    if (!sp.cpus.empty()) {
+        return cpu_numa_node(sp.cpus[0]);
+    }
+    return -1;
+}
+
+// Puts back the edges of ports which a shard graph plugged anew, so
+// the original graph is as it was once the shard graph is gone.
+namespace {
+    class Replugged {
+    public:
+        ~Replugged() {
+            for (auto it = m_saved.rbegin(); it != m_saved.rend(); ++it) {
+                it->first->plug(it->second);
+            }
+        }
+        void save(Port& port) { m_saved.emplace_back(&port, port.edge()); }
+    private:
+        std::vector<std::pair<Port*, Edge> > m_saved;
+    };
+}
+
+WireCell::Configuration Sharding::run(int shard, const std::vector<int>& fds)
+{
+    // Shard zero runs in this process, which must be left as it was
+    // found once the shard and the threads it starts are gone.
+    std::unique_ptr<SavedPlacement> saved;
+    if (shard == 0) {
+        saved.reset(new SavedPlacement);
+    }
+
+    // Place before any thread starts or edge is made so both inherit.
+    const auto& sp = m_placement[shard];
+    if (!sp.cpus.empty() and !pin_cpus(sp.cpus)) {
+        l->warn("shard {} failed to pin to {} CPUs", shard, sp.cpus.size());
+    }
+    if (sp.numa >= 0 and !bind_numa(sp.numa)) {
+        l->warn("shard {} failed to bind memory to NUMA node {}", shard, sp.numa);
+    }
+    const int mydomain = domain(shard);
+
+    const auto& edges = m_graph.edges();
+    ShardSignal signal;
+    // Owns the receivers, which signal, so is destroyed first.
+    Graph graph;
+    // Must drop the edges of the shard graph before it goes.
+    Replugged replugged;
+    std::vector<ShardSender*> senders;
+    std::vector<ShardReceiver*> receivers;
+    // Receivers fed from another NUMA domain.
+    std::unordered_set<ShardReceiver*> remote;
+
+    for (size_t ind=0; ind<m_cross.size(); ++ind) {
+        const auto& e = edges[m_cross[ind]];
+        int wfd = fds[2*ind], rfd = fds[2*ind+1];
+        const std::string& sig = e.tail->oport(e.tpind).signature();
+        if (m_shard[e.tail] == shard) {
+            ::close(rfd);
+            senders.push_back(graph.make_node<ShardSender>(sig, wfd));
+            replugged.save(e.tail->oport(e.tpind));
+            graph.connect(e.tail, senders.back(), e.tpind, 0);
+        }
+        else if (m_shard[e.head] == shard) {
+            ::close(wfd);
+            receivers.push_back(graph.make_node<ShardReceiver>(sig, rfd, signal));
+            int other = domain(m_shard[e.tail]);
+            if (mydomain >= 0 and other >= 0 and other != mydomain) {
+                remote.insert(receivers.back());
+            }
+            replugged.save(e.head->iport(e.hpind));
+            graph.connect(receivers.back(), e.head, 0, e.hpind);
+        }
+        else {
+            ::close(wfd);
+            ::close(rfd);
+        }
+    }
+    for (const auto& e : edges) {
+        if (m_shard[e.tail] == shard and m_shard[e.head] == shard) {
+            replugged.save(e.tail->oport(e.tpind));
+            replugged.save(e.head->iport(e.hpind));
+            graph.connect(e.tail, e.head, e.tpind, e.hpind);
+        }
+    }
+    l->debug("shard {} in pid {} with {} nodes, {} senders, {} receivers",
+             shard, getpid(), graph.sort_kahn().size(),
+             senders.size(), receivers.size());
+
+    // Pools do not survive fork() so each shard makes its own.
+    Context ctx;
+    if (m_nthreads >= 0) {
+        size_t nthreads = m_nthreads;
+        if (!nthreads) {
+            // Shards not placed share the machine rather than each
+            // taking all of it.
+            nthreads = sp.cpus.size();
+            if (!nthreads) {
+                nthreads = std::max<size_t>(1, std::thread::hardware_concurrency() / m_nshards);
+            }
+        }
+        ctx.pool = std::make_shared<ThreadPool>(nthreads);
+    }
+    ctx.buffers = m_buffers;
+    if (ctx.pool or ctx.buffers) {
+        graph.set_context(ctx);
+    }
+    if (m_graph.stats_enabled()) {
+        graph.enable_stats();
+    }
+
+    if (!m_metrics.empty()) {
+        std::string filename = m_metrics;
+        if (shard) {
+            size_t dot = filename.rfind('.');
+            size_t slash = filename.rfind('/');
+            if (dot == std::string::npos or (slash != std::string::npos and dot < slash)) {
+                dot = filename.size();
+            }
+            filename.insert(dot, "-shard" + std::to_string(shard));
+        }
+        graph.set_names(m_graph.names());
+        graph.set_metrics(filename, m_metrics_interval, m_metrics_format);
+    }
+
+    // Each sender may close once the receivers feeding it drain.
+    std::unordered_map<Node*, std::vector<Node*> > parents;
+    for (const auto& e : graph.edges()) {
+        parents[e.head].push_back(e.tail);
+    }
+    std::unordered_map<Node*, ShardReceiver*> byreceiver;
+    for (auto& rec : receivers) {
+        byreceiver[rec] = rec;
+    }
+    std::vector<std::vector<ShardReceiver*> > feeds(senders.size());
+    for (size_t ind=0; ind<senders.size(); ++ind) {
+        std::unordered_set<Node*> seen;
+        std::vector<Node*> todo{senders[ind]};
+        while (!todo.empty()) {
+            Node* node = todo.back();
+            todo.pop_back();
+            for (Node* parent : parents[node]) {
+                if (seen.insert(parent).second) {
+                    todo.push_back(parent);
+                }
+            }
+        }
+        for (Node* node : seen) {
+            auto it = byreceiver.find(node);
+            if (it != byreceiver.end()) {
+                feeds[ind].push_back(it->second);
+            }
+        }
+    }
+
+    // Run until every receiver is drained and a step finds nothing
+    // to do.  Data arriving while a step runs is seen by the next.
+    size_t calls = 0, fired = 0;
+    auto start = std::chrono::steady_clock::now();
+    while (true) {
+        size_t seen;
+        {
+            std::lock_guard<std::mutex> lock(signal.mutex);
+            seen = signal.arrivals;
+        }
+        auto ss = graph.step();
+        calls += ss.calls;
+        fired += ss.fired;
+
+        for (size_t ind=0; ind<senders.size(); ++ind) {
+            if (senders[ind]->closed()) {
+                continue;
+            }
+            bool drained = true;
+            for (auto rec : feeds[ind]) {
+                drained = drained and rec->drained();
+            }
+            if (drained) {
+                senders[ind]->close();
+            }
+        }
+
+        if (ss.fired) {
+            continue;
+        }
+        bool drained = true, starved = false;
+        for (auto& rec : receivers) {
+            drained = drained and rec->drained();
+            starved = starved or rec->starved();
+        }
+        if (drained) {
+            break;
+        }
+        std::unique_lock<std::mutex> lock(signal.mutex);
+        if (signal.arrivals != seen) {
+            continue;
+        }
+        if (!starved) {
+            // What has arrived can not be taken and no more that
+            // might help is expected.  Leave it to diagnose().
+            break;
+        }
+        signal.cond.wait(lock, [&]{ return signal.arrivals != seen; });
+    }
+    for (auto& snd : senders) {
+        snd->close();
+    }
+    graph.publish_metrics();
+    std::chrono::duration<double> dt = std::chrono::steady_clock::now() - start;
+
+    Configuration ret;
+    ret["shard"] = shard;
+    ret["pid"] = (int)getpid();
+    ret["status"] = 0;
+    ret["nodes"] = (int)graph.sort_kahn().size();
+    ret["calls"] = (Json::UInt64)calls;
+    ret["fired"] = (Json::UInt64)fired;
+    ret["seconds"] = dt.count();
+    ret["stalled"] = graph.diagnose()["stalled"];
+    ret["domain"] = mydomain;
+    size_t sent = 0, received = 0, crossed = 0;
+    for (auto& snd : senders) {
+        sent += snd->count();
+    }
+    for (auto& rec : receivers) {
+        received += rec->count();
+        if (remote.count(rec)) {
+            crossed += rec->count();
+        }
+    }
+    ret["sent"] = (Json::UInt64)sent;
+    ret["received"] = (Json::UInt64)received;
+    ret["crossed"] = (Json::UInt64)crossed;
+    ret["stats"] = graph.statistics()["nodes"];
+    return ret;
+}
+
+WireCell::Configuration Sharding::execute()
+{
+    std::vector<int> fds(2*m_cross.size(), -1);
+    for (size_t ind=0; ind<m_cross.size(); ++ind) {
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, &fds[2*ind]) != 0) {
+            THROW(IOError() << errmsg{"pgraph shard: socketpair failed: " + std::string(strerror(errno))});
+        }
+    }
+
+    std::vector<pid_t> pids(m_nshards, -1);
+    std::vector<int> reports(m_nshards, -1);
+    for (size_t shard=1; shard<m_nshards; ++shard) {
+        int pfd[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, pfd) != 0) {
+            THROW(IOError() << errmsg{"pgraph shard: socketpair failed: " + std::string(strerror(errno))});
+        }
+        pid_t pid = fork();
+        if (pid < 0) {
+            THROW(IOError() << errmsg{"pgraph shard: fork failed: " + std::string(strerror(errno))});
+        }
+        if (pid == 0) {
+            // Child: run the shard, report and leave without running
+            // the destructors of components the parent still owns.
+            ::close(pfd[0]);
+            for (size_t other=1; other<shard; ++other) {
+                ::close(reports[other]);
+            }
+            int status = 0;
+            Configuration ret;
+            try {
+                ret = run(shard, fds);
+            }
+            catch (...) {
+                l->critical("shard {} failed", shard);
+                status = 1;
+            }
+            Json::StreamWriterBuilder jwb;
+            jwb["indentation"] = "";
+            std::string text = Json::writeString(jwb, ret);
+            send_all(pfd[1], text.data(), text.size());
+            ::close(pfd[1]);
+            l->flush();
+            _exit(status);
+        }
+        ::close(pfd[1]);
+        pids[shard] = pid;
+        reports[shard] = pfd[0];
+    }
+
+    Configuration ret;
+    ret["shards"] = Json::arrayValue;
+    std::exception_ptr failed;
+    try {
+        ret["shards"].append(run(0, fds));
+    }
+    catch (...) {
+        failed = std::current_exception();
+    }
+
+    for (size_t shard=1; shard<m_nshards; ++shard) {
+        std::string text;
+        char buf[4096];
+        ssize_t n;
+        while ((n = ::read(reports[shard], buf, sizeof(buf))) != 0) {
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                break;
+            }
+            text.append(buf, n);
+        }
+        ::close(reports[shard]);
+
+        int wstatus = 0;
+        while (waitpid(pids[shard], &wstatus, 0) < 0 and errno == EINTR);
+
+        Configuration jshard;
+        Json::CharReaderBuilder jrb;
+        std::string errs;
+        std::stringstream ss(text);
+        if (text.empty() or !Json::parseFromStream(jrb, ss, &jshard, &errs)) {
+            jshard = Configuration();
+        }
+        jshard["shard"] = (int)shard;
+        jshard["pid"] = (int)pids[shard];
+        jshard["status"] = WIFEXITED(wstatus) ? WEXITSTATUS(wstatus) : -1;
+        ret["shards"].append(jshard);
+    }
+
+    if (failed) {
+        std::rethrow_exception(failed);
+    }
+    return ret;
+}
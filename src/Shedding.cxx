@@ -0,0 +1,83 @@
+#include "WireCellPgraph/Shedding.h"
+#include "WireCellUtil/Type.h"
+
+#include <sstream>
+
+using WireCell::demangle;
+using namespace WireCell::Pgraph;
+
+Shedder::Shedder(const std::string& signature, Graph& graph,
+                 const ShedPolicy& policy)
+    : m_graph(graph)
+    , m_policy(policy)
+    , m_ser(Serializers::instance().get(signature))
+    , m_passed(0), m_shed(0), m_over(0)
+    , m_last_pass(std::chrono::steady_clock::now())
+{
+    m_ports[Port::input].push_back(Port(this, Port::input, signature));
+    m_ports[Port::output].push_back(Port(this, Port::output, signature));
+}
+
+Shedder::~Shedder()
+{
+}
+
+bool Shedder::overloaded()
+{
+    if (m_policy.latency > 0 and m_graph.recent_latency() > m_policy.latency) {
+        return true;
+    }
+    if (m_policy.depth and m_graph.max_depth() > m_policy.depth) {
+        return true;
+    }
+    return false;
+}
+
+bool Shedder::operator()()
+{
+    if (!oport().empty()) {
+        return false; // don't call me if I've got existing output waiting
+    }
+    if (iport().empty()) {
+        return false; // don't call me if there is nothing to give me.
+    }
+    auto data = iport().get();
+    if (m_ser->eos(data)) {
+        m_over = 0;
+        oport().put(data);
+        return true;
+    }
+    auto now = std::chrono::steady_clock::now();
+    if (!overloaded()) {
+        m_over = 0;
+    }
+    else if (m_policy.prescale and m_over++ % m_policy.prescale == 0) {
+        // One of every prescale passes.
+    }
+    else if (!probe_due(now)) {
+        ++m_shed;
+        return true;
+    }
+    m_last_pass = now;
+    ++m_passed;
+    oport().put(data);
+    return true;
+}
+
+bool Shedder::probe_due(std::chrono::steady_clock::time_point now)
+{
+    // Latency is only measured when data reaches a sink, so without
+    // a probe it would stay over the limit once all is shed.
+    if (m_policy.prescale or m_policy.latency <= 0) {
+        return false;
+    }
+    std::chrono::duration<double> since = now - m_last_pass;
+    return since.count() >= m_policy.latency;
+}
+
+std::string Shedder::ident()
+{
+    std::stringstream ss;
+    ss << "<Shedder sig:" << demangle(iport().signature()) << ">";
+    return ss.str();
+}
@@ -0,0 +1,218 @@
+#include "WireCellPgraph/Synthetic.h"
+#include "WireCellIface/SimpleFrame.h"
+#include "WireCellIface/SimpleTrace.h"
+#include "WireCellUtil/NamedFactory.h"
+#include "WireCellUtil/Exceptions.h"
+
+#include <chrono>
+
+WIRECELL_FACTORY(SynthSource, WireCell::Pgraph::SynthSource,
+                 WireCell::INode, WireCell::IConfigurable)
+WIRECELL_FACTORY(SynthSink, WireCell::Pgraph::SynthSink,
+                 WireCell::INode, WireCell::IConfigurable)
+WIRECELL_FACTORY(SynthFunction, WireCell::Pgraph::SynthFunction,
+                 WireCell::INode, WireCell::IConfigurable)
+WIRECELL_FACTORY(SynthQueuedout, WireCell::Pgraph::SynthQueuedout,
+                 WireCell::INode, WireCell::IConfigurable)
+WIRECELL_FACTORY(SynthJoin, WireCell::Pgraph::SynthJoin,
+                 WireCell::INode, WireCell::IConfigurable)
+WIRECELL_FACTORY(SynthFanin, WireCell::Pgraph::SynthFanin,
+                 WireCell::INode, WireCell::IConfigurable)
+WIRECELL_FACTORY(SynthSplit, WireCell::Pgraph::SynthSplit,
+                 WireCell::INode, WireCell::IConfigurable)
+WIRECELL_FACTORY(SynthFanout, WireCell::Pgraph::SynthFanout,
+                 WireCell::INode, WireCell::IConfigurable)
+WIRECELL_FACTORY(SynthHydra, WireCell::Pgraph::SynthHydra,
+                 WireCell::INode, WireCell::IConfigurable)
+
+using WireCell::get;
+using namespace WireCell;
+using namespace WireCell::Pgraph;
+
+Synthetic::Synthetic()
+    : m_cpu(0)
+    , m_payload(0)
+    , m_multiplicity(2)
+    , m_count(10)
+    , m_streams(1)
+    , m_inputs(1)
+    , m_outputs(1)
+    , m_concurrency(1)
+    , m_ident(0)
+{
+}
+
+Synthetic::~Synthetic()
+{
+}
+
+WireCell::Configuration Synthetic::default_configuration() const
+{
+    Configuration cfg;
+    // Seconds of CPU time spent in each call.
+    cfg["cpu"] = 0.0;
+    // Samples in each frame made, zero to pass input on as is.
+    cfg["payload"] = 0;
+    // Outputs per input of a queuedout node, else number of ports.
+    cfg["multiplicity"] = 2;
+    // Frames in each stream and number of streams from a source.
+    cfg["count"] = 10;
+    cfg["streams"] = 1;
+    // Ports of a hydra.
+    cfg["inputs"] = 1;
+    cfg["outputs"] = 1;
+    cfg["concurrency"] = 1;
+    return cfg;
+}
+
+void Synthetic::configure(const WireCell::Configuration& cfg)
+{
+    m_cpu = get(cfg, "cpu", m_cpu);
+    m_payload = get<int>(cfg, "payload", m_payload);
+    m_multiplicity = get<int>(cfg, "multiplicity", m_multiplicity);
+    m_count = get<int>(cfg, "count", m_count);
+    m_streams = get<int>(cfg, "streams", m_streams);
+    m_inputs = get<int>(cfg, "inputs", m_inputs);
+    m_outputs = get<int>(cfg, "outputs", m_outputs);
+    m_concurrency = get(cfg, "concurrency", m_concurrency);
+    if (!m_multiplicity or !m_inputs or !m_outputs) {
+        THROW(ValueError() << errmsg{"synthetic node needs at least one of each port"});
+    }
+}
+
+void Synthetic::burn()
+{
+    if (m_cpu <= 0) {
+        return;
+    }
+    // Spin on the clock so the time is spent on the CPU, as real
+    // work would, instead of sleeping.
+    auto end = std::chrono::steady_clock::now() + std::chrono::duration<double>(m_cpu);
+    while (std::chrono::steady_clock::now() < end) {
+    }
+}
+
+std::vector<std::string> Synthetic::types(size_t num)
+{
+    return std::vector<std::string>(num, typeid(IFrame::pointer).name());
+}
+
+bool Synthetic::eos(const boost::any& in)
+{
+    return !boost::any_cast<IFrame::pointer>(in);
+}
+
+IFrame::pointer Synthetic::make()
+{
+    ITrace::vector traces{std::make_shared<SimpleTrace>(0, 0, m_payload)};
+    return std::make_shared<SimpleFrame>(m_ident++, 0, traces);
+}
+
+IFrame::pointer Synthetic::make(const boost::any& in)
+{
+    auto frame = boost::any_cast<IFrame::pointer>(in);
+    if (!frame or !m_payload) {
+        return frame;
+    }
+    return make();
+}
+
+
+bool SynthSource::operator()(boost::any& anyout)
+{
+    if (m_ended == m_streams) {
+        return false;
+    }
+    burn();
+    if (m_made == m_count) {
+        anyout = IFrame::pointer();
+        m_made = 0;
+        ++m_ended;
+        return true;
+    }
+    anyout = make();
+    ++m_made;
+    return true;
+}
+
+bool SynthSink::operator()(const boost::any& /*anyin*/)
+{
+    burn();
+    return true;
+}
+
+bool SynthFunction::operator()(const boost::any& anyin, boost::any& anyout)
+{
+    burn();
+    anyout = make(anyin);
+    return true;
+}
+
+bool SynthQueuedout::operator()(const boost::any& anyin, queuedany& outanyq)
+{
+    burn();
+    if (eos(anyin)) {
+        outanyq.push_back(anyin);
+        return true;
+    }
+    for (size_t ind=0; ind<m_multiplicity; ++ind) {
+        outanyq.push_back(make(anyin));
+    }
+    return true;
+}
+
+bool SynthJoin::operator()(const any_vector& anyins, boost::any& anyout)
+{
+    burn();
+    anyout = make(anyins[0]);
+    return true;
+}
+
+bool SynthFanin::operator()(const any_vector& anyins, boost::any& anyout)
+{
+    burn();
+    anyout = make(anyins[0]);
+    return true;
+}
+
+bool SynthSplit::operator()(const boost::any& anyin, any_vector& anyouts)
+{
+    burn();
+    anyouts.resize(m_multiplicity);
+    for (auto& out : anyouts) {
+        out = make(anyin);
+    }
+    return true;
+}
+
+bool SynthFanout::operator()(const boost::any& anyin, any_vector& anyouts)
+{
+    burn();
+    anyouts.resize(m_multiplicity);
+    for (auto& out : anyouts) {
+        out = make(anyin);
+    }
+    return true;
+}
+
+bool SynthHydra::operator()(any_queue_vector& anyinq, any_queue_vector& anyoutq)
+{
+    bool any = false;
+    while (true) {
+        for (const auto& inq : anyinq) {
+            if (inq.empty()) {
+                return any;
+            }
+        }
+        burn();
+        boost::any first = anyinq[0].front();
+        for (auto& inq : anyinq) {
+            inq.pop_front();
+        }
+        anyoutq.resize(m_outputs);
+        for (auto& outq : anyoutq) {
+            outq.push_back(make(first));
+        }
+        any = true;
+    }
+}
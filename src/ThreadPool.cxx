@@ -0,0 +1,121 @@
+#include "WireCellPgraph/ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+
+using namespace WireCell::Pgraph;
+
+ThreadPool::ThreadPool(size_t nthreads)
+    : m_stop(false)
+{
+    if (!nthreads) {
+        nthreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (size_t ind=0; ind<nthreads; ++ind) {
+        m_workers.emplace_back(&ThreadPool::work, this);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_all();
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_tasks.push_back(std::move(task));
+    }
+    m_cv.notify_one();
+}
+
+void ThreadPool::work()
+{
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [this]{ return m_stop or !m_tasks.empty(); });
+            if (m_tasks.empty()) {
+                return;         // stopping
+            }
+            task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+        }
+        task();
+    }
+}
+
+namespace {
+    // State shared by the threads taking part in one parallel_for.
+    struct Loop {
+        std::function<void(size_t)> func;
+        size_t num;
+        std::atomic<size_t> next{0};
+        size_t ndone{0};
+        std::exception_ptr error;
+        std::mutex mutex;
+        std::condition_variable cv;
+
+        // Take and run items until none are left.
+        void take() {
+            size_t mine = 0;
+            std::exception_ptr err;
+            while (true) {
+                size_t ind = next++;
+                if (ind >= num) {
+                    break;
+                }
+                try {
+                    func(ind);
+                }
+                catch (...) {
+                    if (!err) {
+                        err = std::current_exception();
+                    }
+                }
+                ++mine;
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            if (err and !error) {
+                error = err;
+            }
+            ndone += mine;
+            if (ndone == num) {
+                cv.notify_all();
+            }
+        }
+    };
+}
+
+void ThreadPool::parallel_for(size_t num, std::function<void(size_t)> func)
+{
+    if (!num) {
+        return;
+    }
+    auto loop = std::make_shared<Loop>();
+    loop->func = func;
+    loop->num = num;
+
+    size_t nhelp = std::min(num-1, size());
+    for (size_t ind=0; ind<nhelp; ++ind) {
+        submit([loop]{ loop->take(); });
+    }
+    loop->take();
+
+    std::unique_lock<std::mutex> lock(loop->mutex);
+    loop->cv.wait(lock, [&]{ return loop->ndone == loop->num; });
+    if (loop->error) {
+        std::rethrow_exception(loop->error);
+    }
+}
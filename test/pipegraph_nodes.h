@@ -0,0 +1,110 @@
+/** Simple nodes shared by the pipe graph tests.  Like those in
+ * test_pipegraph.cxx they do not otherwise depend on wire cell and
+ * should not be considered for any other use.  All pass int data.
+ */
+
+#ifndef WIRECELL_PGRAPH_TEST_NODES
+#define WIRECELL_PGRAPH_TEST_NODES
+
+#include "WireCellPgraph/Graph.h"
+#include "WireCellPgraph/Serializer.h"
+#include "WireCellUtil/Testing.h"
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+// The signature of all ports here.
+const std::string int_sig = typeid(int).name();
+
+struct IntSerializer : public WireCell::Pgraph::Serializer {
+    virtual void write(std::ostream& so, const WireCell::Pgraph::Data& data) {
+        int val = boost::any_cast<int>(data);
+        so.write(reinterpret_cast<const char*>(&val), sizeof(val));
+    }
+    virtual WireCell::Pgraph::Data read(std::istream& si) {
+        int val = 0;
+        si.read(reinterpret_cast<char*>(&val), sizeof(val));
+        return val;
+    }
+    virtual bool eos(const WireCell::Pgraph::Data& /*data*/) { return false; }
+};
+
+// Makes num data counting up from zero, waiting delay before each.
+// It keeps its place across a checkpoint.
+class Source : public WireCell::Pgraph::Node {
+public:
+    Source(int num, std::chrono::microseconds delay = std::chrono::microseconds(0))
+        : m_num(0), m_end(num), m_delay(delay) {
+        m_ports[WireCell::Pgraph::Port::output].push_back(
+            WireCell::Pgraph::Port(this, WireCell::Pgraph::Port::output, int_sig));
+    }
+    virtual std::string ident() { return "src"; }
+    virtual bool operator()() {
+        if (m_num >= m_end or !oport().empty()) {
+            return false;
+        }
+        if (m_delay.count()) {
+            std::this_thread::sleep_for(m_delay);
+        }
+        WireCell::Pgraph::Data d = m_num++;
+        oport().put(d);
+        return true;
+    }
+    virtual bool save_state(std::string& state) {
+        state = std::to_string(m_num);
+        return true;
+    }
+    virtual void load_state(const std::string& state) { m_num = std::stoi(state); }
+private:
+    int m_num, m_end;
+    std::chrono::microseconds m_delay;
+};
+
+class Pass : public WireCell::Pgraph::Node {
+public:
+    Pass() {
+        m_ports[WireCell::Pgraph::Port::input].push_back(
+            WireCell::Pgraph::Port(this, WireCell::Pgraph::Port::input, int_sig));
+        m_ports[WireCell::Pgraph::Port::output].push_back(
+            WireCell::Pgraph::Port(this, WireCell::Pgraph::Port::output, int_sig));
+    }
+    virtual std::string ident() { return "pass"; }
+    virtual bool operator()() {
+        if (iport().empty() or !oport().empty()) {
+            return false;
+        }
+        oport().put(iport().get());
+        return true;
+    }
+};
+
+// Counts what it gets, which must be in the order a Source made it.
+// It keeps its count across a checkpoint.
+class Sink : public WireCell::Pgraph::Node {
+public:
+    Sink() : m_count(0) {
+        m_ports[WireCell::Pgraph::Port::input].push_back(
+            WireCell::Pgraph::Port(this, WireCell::Pgraph::Port::input, int_sig));
+    }
+    virtual std::string ident() { return "dst"; }
+    virtual bool operator()() {
+        if (iport().empty()) {
+            return false;
+        }
+        int d = boost::any_cast<int>(iport().get());
+        Assert(d == m_count);
+        ++m_count;
+        return true;
+    }
+    int count() { return m_count; }
+    virtual bool save_state(std::string& state) {
+        state = std::to_string(m_count);
+        return true;
+    }
+    virtual void load_state(const std::string& state) { m_count = std::stoi(state); }
+private:
+    int m_count;
+};
+
+#endif
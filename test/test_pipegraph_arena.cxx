@@ -0,0 +1,79 @@
+/** This test exercises the Arena holding the parts of a graph: the
+ * alignment of what it hands out, requests larger than a chunk and
+ * the order in which objects made in it are destroyed.
+ */
+
+#include "WireCellPgraph/Arena.h"
+#include "WireCellUtil/Testing.h"
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+using namespace WireCell;
+using namespace std;
+
+static bool aligned(const void* ptr, size_t align) {
+    return reinterpret_cast<uintptr_t>(ptr) % align == 0;
+}
+
+struct alignas(64) Wide {
+    char data[3];
+};
+
+// Notes its number when destroyed.
+struct Noted {
+    Noted(int num, std::vector<int>& order) : m_num(num), m_order(order) {}
+    ~Noted() { m_order.push_back(m_num); }
+    int m_num;
+    std::vector<int>& m_order;
+};
+
+int main() {
+    // Alignment holds however odd what came before.
+    {
+        Pgraph::Arena arena(256);
+        for (size_t align : {1, 2, 4, 8, 16, 32, 64}) {
+            arena.allocate(3, 1);
+            void* mem = arena.allocate(5, align);
+            Assert(aligned(mem, align));
+        }
+        arena.allocate(1, 1);
+        Wide* wide = arena.make<Wide>();
+        Assert(aligned(wide, alignof(Wide)));
+    }
+
+    // Larger than a chunk gets a chunk of its own and small ones
+    // carry on after it.
+    {
+        Pgraph::Arena arena(128);
+        arena.allocate(8, 8);
+        Assert(arena.chunks() == 1);
+        char* big = static_cast<char*>(arena.allocate(1000, 16));
+        Assert(aligned(big, 16));
+        Assert(arena.chunks() == 2);
+        for (size_t ind=0; ind<1000; ++ind) {
+            big[ind] = 1;
+        }
+        void* small = arena.allocate(8, 8);
+        Assert(aligned(small, 8));
+        Assert(arena.bytes() == 1016);
+        cout << "chunks: " << arena.chunks() << endl;
+    }
+
+    // Destroyed in reverse order made.
+    std::vector<int> order;
+    {
+        Pgraph::Arena arena(64);
+        for (int num=0; num<10; ++num) {
+            arena.make<Noted>(num, order);
+        }
+        Assert(order.empty());
+    }
+    Assert(order.size() == 10);
+    for (int num=0; num<10; ++num) {
+        Assert(order[num] == 9 - num);
+    }
+
+    return 0;
+}
@@ -0,0 +1,94 @@
+/** This test exercises tuning from known node costs, in particular
+ * the split of a graph into shards.
+ */
+
+#include "WireCellPgraph/Autotune.h"
+#include "pipegraph_nodes.h"
+
+#include <iostream>
+
+using namespace WireCell;
+using namespace std;
+
+// Never called, only placed.
+class Stage : public Pgraph::Node {
+public:
+    Stage(std::string name, std::string isig, std::string osig) : m_name(name) {
+        if (!isig.empty()) {
+            m_ports[Pgraph::Port::input].push_back(
+                Pgraph::Port(this, Pgraph::Port::input, isig));
+        }
+        if (!osig.empty()) {
+            m_ports[Pgraph::Port::output].push_back(
+                Pgraph::Port(this, Pgraph::Port::output, osig));
+        }
+    }
+    virtual std::string ident() { return m_name; }
+    virtual bool operator()() { return false; }
+private:
+    std::string m_name;
+};
+
+// Tune a chain of nodes with the given costs.  The edge out of node
+// nocut has no serializer and so may not be cut.
+static Configuration tune_chain(const std::vector<double>& costs,
+                                size_t nshards, size_t nocut=~0UL)
+{
+    std::vector<std::unique_ptr<Stage> > stages;
+    Pgraph::NodeNames names;
+    Configuration profile;
+    for (size_t ind=0; ind<costs.size(); ++ind) {
+        std::string isig = ind ? (ind-1 == nocut ? "nope" : int_sig) : "";
+        std::string osig = ind+1 < costs.size() ? (ind == nocut ? "nope" : int_sig) : "";
+        std::string name = "stage:" + std::to_string(ind);
+        stages.emplace_back(new Stage(name, isig, osig));
+        names[stages.back().get()] = name;
+        Configuration jnode;
+        jnode["node"] = name;
+        jnode["seconds"] = costs[ind];
+        profile["nodes"].append(jnode);
+    }
+    Pgraph::Graph graph;
+    for (size_t ind=1; ind<stages.size(); ++ind) {
+        graph.connect(stages[ind-1].get(), stages[ind].get());
+    }
+    auto overlay = Pgraph::autotune(graph, names, profile, nshards);
+    cout << overlay << endl;
+    return overlay;
+}
+
+static std::vector<size_t> sizes(const Configuration& overlay)
+{
+    std::vector<size_t> ret;
+    for (auto jshard : overlay["shards"]) {
+        ret.push_back(jshard.size());
+    }
+    return ret;
+}
+
+int main() {
+    Pgraph::Serializers::instance().bind<int>(new IntSerializer);
+
+    // Halves of equal cost.
+    auto overlay = tune_chain({1, 4, 4, 1}, 2);
+    Assert(overlay["weight"].asDouble() == 10);
+    Assert(sizes(overlay) == std::vector<size_t>({2, 2}));
+    Assert(overlay["shards"][1][0].asString() == "stage:2");
+    // The costliest node takes 4 of 10 so at most 3 threads help.
+    Assert(overlay["threads"].asInt() >= 1);
+    Assert(overlay["threads"].asInt() <= 3);
+
+    // Thirds of equal cost.
+    overlay = tune_chain({1, 1, 1, 1, 1, 1}, 3);
+    Assert(sizes(overlay) == std::vector<size_t>({2, 2, 2}));
+
+    // The best cut is not allowed so the next one is taken.
+    overlay = tune_chain({1, 4, 4, 1}, 2, 1);
+    Assert(sizes(overlay) == std::vector<size_t>({3, 1}));
+
+    // No split unless asked for.
+    overlay = tune_chain({1, 4, 4, 1}, 1);
+    Assert(!overlay.isMember("shards"));
+
+    return 0;
+}
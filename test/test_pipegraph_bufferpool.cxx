@@ -0,0 +1,75 @@
+/** This test exercises reuse of buffers from a BufferPool, the limit
+ * on what it holds and buffers outliving their pool.
+ */
+
+#include "WireCellPgraph/BufferPool.h"
+#include "WireCellUtil/Testing.h"
+
+#include <iostream>
+
+using namespace WireCell;
+using namespace std;
+
+int main() {
+    // Reuse of a buffer of similar size, handed out as if new.
+    {
+        Pgraph::BufferPool pool;
+        auto buf = pool.acquire<double>(100);
+        Assert(buf->size() == 100);
+        const double* data = buf->data();
+        (*buf)[0] = 42;
+        buf.reset();
+        Assert(pool.held() == 1024);
+
+        buf = pool.acquire<double>(90);
+        Assert(buf->data() == data);
+        Assert(buf->size() == 90);
+        Assert((*buf)[0] == 0);
+        Assert(pool.hits() == 1);
+        Assert(pool.misses() == 1);
+        Assert(pool.held() == 0);
+
+        // Another type is not mixed in.
+        auto other = pool.acquire<float>(100);
+        Assert(pool.misses() == 2);
+    }
+
+    // A buffer grown by its user is filed and counted by its new size.
+    {
+        Pgraph::BufferPool pool;
+        auto buf = pool.acquire<double>(100);
+        buf->resize(1000);
+        size_t have = buf->capacity() * sizeof(double);
+        buf.reset();
+        Assert(pool.held() == have);
+
+        buf = pool.acquire<double>(500);
+        Assert(pool.hits() == 1);
+        Assert(pool.held() == 0);
+        Assert(buf->capacity() * sizeof(double) == have);
+    }
+
+    // No more than maxbytes is held.
+    {
+        Pgraph::BufferPool pool(1024);
+        auto one = pool.acquire<double>(128);
+        auto two = pool.acquire<double>(128);
+        one.reset();
+        two.reset();
+        Assert(pool.held() == 1024);
+        cout << "held " << pool.held() << " bytes\n";
+    }
+
+    // Buffers may outlive the pool.
+    {
+        std::shared_ptr<std::vector<double> > buf;
+        {
+            Pgraph::BufferPool pool;
+            buf = pool.acquire<double>(10);
+        }
+        (*buf)[9] = 1;
+        buf.reset();
+    }
+
+    return 0;
+}
@@ -0,0 +1,55 @@
+/** This test exercises running several pipe graphs together on one
+ * executor with steps of fewer node calls than it takes to sweep a
+ * graph.
+ */
+
+#include "WireCellPgraph/Executor.h"
+#include "pipegraph_nodes.h"
+
+#include <iostream>
+
+using namespace WireCell;
+using namespace std;
+
+// A chain of a source, npass pass nodes and a sink.
+struct Chain {
+    static const int npass = 6;
+    Source src;
+    Pass pass[npass];
+    Sink dst;
+    Pgraph::Graph graph;
+
+    Chain(int num) : src(num) {
+        graph.connect(&src, &pass[0]);
+        for (int ind=1; ind<npass; ++ind) {
+            graph.connect(&pass[ind-1], &pass[ind]);
+        }
+        graph.connect(&pass[npass-1], &dst);
+    }
+};
+
+int main() {
+    const int nsource = 100;
+    Chain one(nsource), two(nsource);
+
+    auto& ex = Pgraph::Executor::named("test");
+    ex.set_threads(2);
+    ex.set_quantum(2);
+    ex.add(&one.graph, "one");
+    // A graph may keep its own step size.
+    ex.add(&two.graph, "two", 2.0, nullptr, 3);
+
+    auto stats = ex.run();
+    cout << stats << endl;
+    Assert(one.dst.count() == nsource);
+    Assert(two.dst.count() == nsource);
+    for (auto jg : stats["graphs"]) {
+        // Every node fires once per datum.
+        Assert(jg["fired"].asInt() == (Chain::npass + 2) * nsource);
+    }
+    Assert(stats["graphs"][0]["quantum"].asInt() == 2);
+    Assert(stats["graphs"][1]["quantum"].asInt() == 3);
+    Assert(!ex.pending(&one.graph));
+
+    return 0;
+}
@@ -0,0 +1,91 @@
+/** This test exercises pruning a pipe graph to what its targets need.
+ * It checks that pruned nodes are never called, that a kept node
+ * whose output led only to pruned nodes is not blocked by it and
+ * that a target must be in the graph.
+ */
+
+#include "WireCellUtil/Exceptions.h"
+#include "pipegraph_nodes.h"
+
+#include <iostream>
+
+using namespace WireCell;
+using namespace std;
+
+// Sends each datum out both of its ports, only once both are empty.
+class Split : public Pgraph::Node {
+public:
+    Split() {
+        m_ports[Pgraph::Port::input].push_back(
+            Pgraph::Port(this, Pgraph::Port::input, int_sig));
+        for (int ind=0; ind<2; ++ind) {
+            m_ports[Pgraph::Port::output].push_back(
+                Pgraph::Port(this, Pgraph::Port::output, int_sig));
+        }
+    }
+    virtual std::string ident() { return "split"; }
+    virtual bool operator()() {
+        if (iport().empty() or !oport(0).empty() or !oport(1).empty()) {
+            return false;
+        }
+        auto d = iport().get();
+        oport(0).put(d);
+        oport(1).put(d);
+        return true;
+    }
+};
+
+// A Pass counting how often it is called.
+class Watched : public Pass {
+public:
+    virtual bool operator()() {
+        ++calls;
+        return Pass::operator()();
+    }
+    int calls{0};
+};
+
+int main() {
+    const int nsource = 10;
+
+    Source src(nsource);
+    Split split;
+    Watched kept, pruned;
+    Sink target, unwanted;
+    Source other_src(nsource);
+    Sink other_dst;
+
+    Pgraph::Graph g;
+    g.connect(&src, &split);
+    g.connect(&split, &kept, 0, 0);
+    g.connect(&kept, &target);
+    g.connect(&split, &pruned, 1, 0);
+    g.connect(&pruned, &unwanted);
+    g.connect(&other_src, &other_dst);
+
+    size_t nremoved = g.prune({&target});
+    Assert(nremoved == 4);
+
+    g.execute();
+    cout << "target got " << target.count() << endl;
+    Assert(target.count() == nsource);
+    Assert(kept.calls > 0);
+    Assert(pruned.calls == 0);
+    Assert(unwanted.count() == 0);
+    Assert(other_dst.count() == 0);
+    // What split sent to the pruned branch went nowhere.
+    Assert(split.oport(1).empty());
+
+    // A target must be in the graph.
+    Sink stray;
+    bool threw = false;
+    try {
+        g.prune({&stray});
+    }
+    catch (ValueError&) {
+        threw = true;
+    }
+    Assert(threw);
+
+    return 0;
+}
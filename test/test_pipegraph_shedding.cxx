@@ -0,0 +1,153 @@
+/** This test exercises shedding data while a graph is over a limit.
+ * It checks that every datum is either passed or counted as shed,
+ * that end-of-stream always passes, that a prescale lets one in so
+ * many through and that while shedding all on latency a probe is let
+ * through so the graph can recover.
+ */
+
+#include "WireCellPgraph/Shedding.h"
+#include "pipegraph_nodes.h"
+
+#include <iostream>
+#include <vector>
+
+using namespace WireCell;
+using namespace std;
+
+// Negative data is end-of-stream.
+struct EosSerializer : public IntSerializer {
+    virtual bool eos(const Pgraph::Data& data) { return boost::any_cast<int>(data) < 0; }
+};
+
+// Puts all its data on its edge in one call.
+class Feed : public Pgraph::Node {
+public:
+    Feed(const std::vector<int>& data) : m_data(data) {
+        m_ports[Pgraph::Port::output].push_back(
+            Pgraph::Port(this, Pgraph::Port::output, int_sig));
+    }
+    virtual std::string ident() { return "feed"; }
+    virtual bool operator()() {
+        for (int one : m_data) {
+            oport().put(Pgraph::Data(one));
+        }
+        bool ret = !m_data.empty();
+        m_data.clear();
+        return ret;
+    }
+private:
+    std::vector<int> m_data;
+};
+
+// Counts data and end-of-stream, the first call taking a while.
+class Count : public Pgraph::Node {
+public:
+    Count(std::chrono::milliseconds first = std::chrono::milliseconds(0))
+        : m_first(first) {
+        m_ports[Pgraph::Port::input].push_back(
+            Pgraph::Port(this, Pgraph::Port::input, int_sig));
+    }
+    virtual std::string ident() { return "count"; }
+    virtual bool operator()() {
+        if (iport().empty()) {
+            return false;
+        }
+        int d = boost::any_cast<int>(iport().get());
+        if (d < 0) {
+            ++neos;
+        }
+        else {
+            ++ndata;
+        }
+        if (ndata + neos == 1) {
+            std::this_thread::sleep_for(m_first);
+        }
+        return true;
+    }
+    int ndata{0}, neos{0};
+private:
+    std::chrono::milliseconds m_first;
+};
+
+// Feed the data all at once and run the shedder alone, taking what
+// it passes as it goes.  While more than depth remain it is over.
+static void shed_depth(const std::vector<int>& data, Pgraph::ShedPolicy policy,
+                       Pgraph::Shedder*& shedder, Count& count)
+{
+    Feed feed(data);
+    Pgraph::Graph graph;
+    shedder = graph.make_node<Pgraph::Shedder>(int_sig, graph, policy);
+    graph.connect(&feed, shedder);
+    graph.connect(shedder, &count);
+    feed();
+    while ((*shedder)()) {
+        count();
+    }
+}
+
+int main() {
+    Pgraph::Serializers::instance().bind<int>(new EosSerializer);
+
+    // One in four pass while over, all once under.
+    {
+        std::vector<int> data;
+        for (int ind=0; ind<40; ++ind) {
+            data.push_back(ind);
+        }
+        data.push_back(-1);
+        Pgraph::ShedPolicy policy;
+        policy.depth = 2;
+        policy.prescale = 4;
+        Pgraph::Shedder* shedder = nullptr;
+        Count count;
+        shed_depth(data, policy, shedder, count);
+        cout << "prescale: passed " << shedder->passed()
+             << " shed " << shedder->shed() << endl;
+        // Over for the first 38 taken: 10 of them pass.  The last
+        // two data and end-of-stream are taken once under.
+        Assert(shedder->passed() + shedder->shed() == 40);
+        Assert(shedder->passed() == 12);
+        Assert(count.ndata == 12);
+        Assert(count.neos == 1);
+    }
+
+    // End-of-stream passes even while shedding all.
+    {
+        std::vector<int> data{-1};
+        for (int ind=0; ind<10; ++ind) {
+            data.push_back(ind);
+        }
+        Pgraph::ShedPolicy policy;
+        policy.depth = 2;
+        Pgraph::Shedder* shedder = nullptr;
+        Count count;
+        shed_depth(data, policy, shedder, count);
+        Assert(count.neos == 1);
+        Assert(shedder->shed() == 7);
+        Assert(shedder->passed() == 3);
+        Assert(count.ndata == 3);
+    }
+
+    // A slow first datum puts the latency over the limit and, with
+    // nothing else passing, only probes can bring it back under.
+    {
+        const int nsource = 100;
+        Source src(nsource, std::chrono::milliseconds(1));
+        Count count(std::chrono::milliseconds(150));
+        Pgraph::ShedPolicy policy;
+        policy.latency = 0.05;
+        Pgraph::Graph graph;
+        auto shedder = graph.make_node<Pgraph::Shedder>(int_sig, graph, policy);
+        graph.connect(&src, shedder);
+        graph.connect(shedder, &count);
+        graph.enable_latency();
+        graph.execute();
+        cout << "latency: passed " << shedder->passed()
+             << " shed " << shedder->shed() << endl;
+        Assert(shedder->passed() + shedder->shed() == nsource);
+        Assert(shedder->passed() == (size_t)count.ndata);
+        Assert(shedder->passed() > 1);
+    }
+
+    return 0;
+}
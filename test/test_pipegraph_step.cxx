@@ -0,0 +1,64 @@
+/** This test exercises stepping a pipe graph a bounded amount at a
+ * time as a host event loop would.
+ */
+
+#include "pipegraph_nodes.h"
+
+#include <iostream>
+
+using namespace WireCell;
+using namespace std;
+
+int main() {
+    const int nsource = 10;
+    Source src(nsource);
+    Sink dst;
+
+    Pgraph::Graph g;
+    g.connect(&src, &dst);
+
+    auto ss = g.step(3);
+    Assert(ss.calls == 3);
+    Assert(!ss.done);
+
+    int nsteps = 1;
+    while (!ss.done) {
+        ss = g.step(3);
+        ++nsteps;
+    }
+    cout << "done in " << nsteps << " steps\n";
+    Assert(dst.count() == nsource);
+
+    // A finished graph is immediately done.
+    ss = g.step(0, std::chrono::steady_clock::now());
+    Assert(ss.calls == 0);
+    ss = g.step();
+    Assert(ss.done);
+    Assert(ss.fired == 0);
+
+    // Steps smaller than the chain still reach its source.
+    Source deep_src(nsource);
+    Pass pass[4];
+    Sink deep_dst;
+    Pgraph::Graph deep;
+    deep.connect(&deep_src, &pass[0]);
+    for (int ind=1; ind<4; ++ind) {
+        deep.connect(&pass[ind-1], &pass[ind]);
+    }
+    deep.connect(&pass[3], &deep_dst);
+
+    nsteps = 0;
+    size_t nfired = 0;
+    do {
+        ss = deep.step(2);
+        Assert(ss.calls <= 2);
+        nfired += ss.fired;
+        ++nsteps;
+        Assert(nsteps < 1000);
+    } while (!ss.done);
+    cout << "deep done in " << nsteps << " steps\n";
+    Assert(deep_dst.count() == nsource);
+    Assert(nfired == 6*nsource);
+
+    return 0;
+}
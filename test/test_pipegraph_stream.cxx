@@ -0,0 +1,135 @@
+/** This test exercises a queuedout node which implements IStreaming
+ * and so is asked for its outputs a chunk at a time.  It checks that
+ * the output edge never holds more than a chunk and that
+ * end-of-stream is passed on after all else.  No plugins are loaded.
+ */
+
+#include "WireCellPgraph/Wrappers.h"
+#include "WireCellUtil/Testing.h"
+
+#include <iostream>
+
+using namespace WireCell;
+using namespace std;
+
+typedef std::shared_ptr<int> IntPtr;
+
+// Expands each input n into nper outputs of n*1000+i.  A null input
+// is end-of-stream and is passed on as is.
+class Slicer : public IQueuedoutNodeBase, public Pgraph::IStreaming {
+public:
+    Slicer(int nper, size_t chunk) : m_nper(nper), m_chunk(chunk), m_left(0), m_base(0), m_eos(false) {}
+    virtual std::string signature() { return typeid(Slicer).name(); }
+    virtual std::vector<std::string> input_types() { return {typeid(IntPtr).name()}; }
+    virtual std::vector<std::string> output_types() { return {typeid(IntPtr).name()}; }
+
+    // Streaming nodes are never called this way.
+    virtual bool operator()(const boost::any& /*in*/, queuedany& /*outq*/) {
+        Assert(false);
+        return false;
+    }
+
+    virtual bool begin(const boost::any& in) {
+        auto ptr = boost::any_cast<IntPtr>(in);
+        m_eos = !ptr;
+        m_left = m_eos ? 0 : m_nper;
+        m_base = m_eos ? 0 : *ptr * 1000;
+        return true;
+    }
+    virtual bool next(queuedany& outq, size_t max) {
+        Assert(max <= m_chunk);
+        if (m_eos) {
+            outq.push_back(IntPtr());
+            return false;
+        }
+        while (max-- and m_left) {
+            outq.push_back(std::make_shared<int>(m_base + m_nper - m_left));
+            --m_left;
+        }
+        return m_left > 0;
+    }
+    virtual size_t chunk() const { return m_chunk; }
+
+private:
+    int m_nper;
+    size_t m_chunk;
+    int m_left, m_base;
+    bool m_eos;
+};
+
+// Makes num data then end-of-stream.
+class Source : public Pgraph::Node {
+public:
+    Source(int num) : m_num(0), m_end(num) {
+        m_ports[Pgraph::Port::output].push_back(
+            Pgraph::Port(this, Pgraph::Port::output, typeid(IntPtr).name()));
+    }
+    virtual std::string ident() { return "src"; }
+    virtual bool operator()() {
+        if (m_num > m_end or !oport().empty()) {
+            return false;
+        }
+        Pgraph::Data d = m_num < m_end ? std::make_shared<int>(m_num) : IntPtr();
+        ++m_num;
+        oport().put(d);
+        return true;
+    }
+private:
+    int m_num, m_end;
+};
+
+// Checks the order of what it gets and notes the deepest its input
+// edge has been.
+class Sink : public Pgraph::Node {
+public:
+    Sink(int nper) : m_nper(nper), m_count(0), m_neos(0), m_peak(0) {
+        m_ports[Pgraph::Port::input].push_back(
+            Pgraph::Port(this, Pgraph::Port::input, typeid(IntPtr).name()));
+    }
+    virtual std::string ident() { return "dst"; }
+    virtual bool operator()() {
+        m_peak = std::max(m_peak, iport().size());
+        if (iport().empty()) {
+            return false;
+        }
+        auto ptr = boost::any_cast<IntPtr>(iport().get());
+        if (!ptr) {
+            ++m_neos;
+            return true;
+        }
+        Assert(m_neos == 0);
+        Assert(*ptr == (m_count / m_nper) * 1000 + m_count % m_nper);
+        ++m_count;
+        return true;
+    }
+    int count() { return m_count; }
+    int neos() { return m_neos; }
+    size_t peak() { return m_peak; }
+private:
+    int m_nper, m_count, m_neos;
+    size_t m_peak;
+};
+
+int main() {
+    const int nsource = 3, nper = 50;
+    const size_t chunk = 4;
+
+    auto slicer = std::make_shared<Slicer>(nper, chunk);
+    Pgraph::Queuedout queuedout(slicer);
+    Source src(nsource);
+    Sink dst(nper);
+
+    Pgraph::Graph g;
+    g.connect(&src, &queuedout);
+    g.connect(&queuedout, &dst);
+    g.execute();
+
+    cout << "got " << dst.count() << " and " << dst.neos()
+         << " EOS, deepest edge " << dst.peak() << endl;
+    Assert(dst.count() == nsource * nper);
+    Assert(dst.neos() == 1);
+    Assert(dst.peak() >= 1);
+    Assert(dst.peak() <= chunk);
+
+    return 0;
+}